@@ -0,0 +1,56 @@
+#include "BPM2TimeLookAndFeel.h"
+
+BPM2TimeLookAndFeel::BPM2TimeLookAndFeel()
+    : regularTypeface (juce::Font (juce::FontOptions()).getTypefacePtr()),
+      boldTypeface (juce::Font (juce::FontOptions().withStyle ("Bold")).getTypefacePtr()),
+      titleFont   (juce::FontOptions (boldTypeface).withHeight (18.0f)),
+      sectionFont (juce::FontOptions (boldTypeface).withHeight (11.0f)),
+      bpmFont     (juce::FontOptions (boldTypeface).withHeight (13.0f)),
+      msFont      (juce::FontOptions (boldTypeface).withHeight (32.0f)),
+      statusFont  (juce::FontOptions (regularTypeface).withHeight (12.0f))
+{
+    setColour (juce::ResizableWindow::backgroundColourId, juce::Colour (Palette::background));
+
+    setColour (juce::TextButton::buttonColourId, juce::Colour (Palette::panel));
+    setColour (juce::TextButton::buttonOnColourId, juce::Colour (Palette::accent));
+    setColour (juce::TextButton::textColourOffId, juce::Colours::lightgrey);
+    setColour (juce::TextButton::textColourOnId, juce::Colours::white);
+
+    setColour (juce::ToggleButton::textColourId, juce::Colours::white);
+    setColour (juce::ToggleButton::tickColourId, juce::Colour (Palette::accent));
+    setColour (juce::ToggleButton::tickDisabledColourId, juce::Colours::darkgrey);
+
+    setColour (juce::Slider::trackColourId, juce::Colour (Palette::track));
+    setColour (juce::Slider::thumbColourId, juce::Colour (Palette::accent));
+    setColour (juce::Slider::backgroundColourId, juce::Colour (Palette::panelDark));
+    setColour (juce::Slider::textBoxTextColourId, juce::Colours::white);
+    setColour (juce::Slider::textBoxBackgroundColourId, juce::Colour (Palette::panel));
+    setColour (juce::Slider::textBoxOutlineColourId, juce::Colours::transparentBlack);
+
+    setColour (juce::Label::textColourId, juce::Colours::lightgrey);
+}
+
+void BPM2TimeLookAndFeel::drawStaticText (juce::Graphics& g, const juce::String& text, const juce::FontOptions& font,
+                                          juce::Rectangle<int> area, juce::Justification justification) const
+{
+    // Layouts are kept at the origin and moved into place when drawn, so the cache doesn't
+    // depend on where any particular editor puts its text
+    const auto fontKey = juce::String (font.getHeight()) + font.getName() + font.getStyle()
+                       + juce::String::toHexString ((juce::pointer_sized_int) font.getTypeface().get());
+    const auto key = std::make_pair (text, fontKey);
+    auto cached = staticTextCache.find (key);
+
+    if (cached == staticTextCache.end())
+    {
+        CachedText entry;
+        entry.glyphs.addLineOfText (juce::Font (font), text, 0.0f, 0.0f);
+        entry.bounds = entry.glyphs.getBoundingBox (0, -1, true);
+        cached = staticTextCache.emplace (key, std::move (entry)).first;
+    }
+
+    const auto& entry = cached->second;
+    const auto placed = justification.appliedToRectangle (entry.bounds, area.toFloat());
+
+    entry.glyphs.draw (g, juce::AffineTransform::translation (placed.getX() - entry.bounds.getX(),
+                                                               placed.getY() - entry.bounds.getY()));
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <JuceHeader.h>
+
+namespace Palette
+{
+    constexpr juce::uint32 background   = 0xff1e1e1e;
+    constexpr juce::uint32 panel        = 0xff2a2a2a;
+    constexpr juce::uint32 panelDark    = 0xff1a1a1a;
+    constexpr juce::uint32 divider      = 0xff3a3a3a;
+    constexpr juce::uint32 track        = 0xff4a4a4a;
+    constexpr juce::uint32 accent       = 0xff4a90e2;
+    constexpr juce::uint32 accentBright = 0xff6fb0ff;
+}
+
+/** The plugin's look: colour scheme, typefaces and cached layouts of static text.
+
+    Every editor in the process shares a single instance through a
+    juce::SharedResourcePointer, so opening another editor doesn't rebuild any of it.
+*/
+class BPM2TimeLookAndFeel : public juce::LookAndFeel_V4
+{
+    // Resolved once, so every editor's fonts share the same typeface objects and the glyph
+    // caches that go with them. Declared first because the fonts below are built from them.
+    const juce::Typeface::Ptr regularTypeface;
+    const juce::Typeface::Ptr boldTypeface;
+
+public:
+    BPM2TimeLookAndFeel();
+
+    const juce::FontOptions titleFont;
+    const juce::FontOptions sectionFont;
+    const juce::FontOptions bpmFont;
+    const juce::FontOptions msFont;
+    const juce::FontOptions statusFont;
+
+    /** Draws a line of text that never changes, such as a caption, from a glyph layout
+        that's shaped the first time it's drawn and reused after that. Message thread only.
+    */
+    void drawStaticText (juce::Graphics&, const juce::String& text, const juce::FontOptions&,
+                         juce::Rectangle<int> area, juce::Justification) const;
+
+private:
+    struct CachedText
+    {
+        juce::GlyphArrangement glyphs;
+        juce::Rectangle<float> bounds;  // The laid-out line, with its baseline at y = 0
+    };
+
+    mutable std::map<std::pair<juce::String, juce::String>, CachedText> staticTextCache;
+};
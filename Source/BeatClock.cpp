@@ -0,0 +1,65 @@
+#include "BeatClock.h"
+
+void BeatClock::publish (const BeatStamp& newStamp) noexcept
+{
+    const auto seq = sequence.load (std::memory_order_relaxed);
+    sequence.store (seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence (std::memory_order_release);
+    std::memcpy (&stamp, &newStamp, sizeof (BeatStamp));
+    sequence.store (seq + 2, std::memory_order_release);
+}
+
+bool BeatClock::read (BeatStamp& result) const noexcept
+{
+    for (int attempt = 0; attempt < 16; ++attempt)
+    {
+        const auto before = sequence.load (std::memory_order_acquire);
+
+        if ((before & 1u) != 0 || before == 0)
+            continue;
+
+        std::memcpy (&result, &stamp, sizeof (BeatStamp));
+        std::atomic_thread_fence (std::memory_order_acquire);
+
+        if (sequence.load (std::memory_order_relaxed) == before)
+            return true;
+    }
+
+    return false;
+}
+
+int64_t BeatClock::nowNs() noexcept
+{
+    return (int64_t) (juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks()) * 1.0e9);
+}
+
+int64_t BeatClock::getReferenceNs (const BeatStamp& s) noexcept
+{
+    // A host time more than a second away from when we saw the block can't be on our clock
+    constexpr int64_t maxHostTimeOffsetNs = 1000000000;
+
+    if (s.hostTimeNs != 0 && std::abs (s.publishedNs - s.hostTimeNs) < maxHostTimeOffsetNs)
+        return s.hostTimeNs;
+
+    return s.publishedNs;
+}
+
+double BeatClock::extrapolatePpq (const BeatStamp& s, int64_t now) noexcept
+{
+    if (! s.isPlaying || s.bpm <= 0.0)
+        return s.ppqPosition;
+
+    // Never run more than a second ahead of the last stamp, e.g. if the host stalls
+    const auto elapsedSeconds = juce::jlimit (0.0, 1.0, (double) (now - getReferenceNs (s)) * 1.0e-9);
+    return s.ppqPosition + elapsedSeconds * s.bpm / 60.0;
+}
+
+std::pair<int, double> BeatClock::getBeatAndPhase (const BeatStamp& s, double ppq) noexcept
+{
+    const auto numBeats = juce::jmax (1, s.timeSigNumerator);
+    const auto beatsPerQuarter = juce::jmax (1, s.timeSigDenominator) / 4.0;
+    const auto intoBar = juce::jmax (0.0, ppq - s.ppqOfLastBarStart) * beatsPerQuarter;
+    const auto beat = (int) std::floor (intoBar);
+
+    return { beat % numBeats, intoBar - std::floor (intoBar) };
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <JuceHeader.h>
+
+/** Where the transport was at the start of a block, and when. */
+struct BeatStamp
+{
+    int64_t publishedNs = 0;            // BeatClock::nowNs() when published
+    int64_t hostTimeNs = 0;             // Host's time for the start of the block, or 0 if it gave none
+    double ppqPosition = 0.0;
+    double ppqOfLastBarStart = 0.0;
+    double bpm = 120.0;
+    int timeSigNumerator = 4;
+    int timeSigDenominator = 4;
+    bool isPlaying = false;
+};
+
+/** Hands the latest BeatStamp from the audio thread to the message thread.
+
+    The audio thread publishes once per block. Readers take a consistent copy through a
+    sequence counter, so neither side ever blocks the other.
+*/
+class BeatClock
+{
+public:
+    void publish (const BeatStamp&) noexcept;
+    bool read (BeatStamp&) const noexcept;
+
+    /** The high-resolution clock, in nanoseconds. Hosts report their time for each block
+        on this clock too.
+    */
+    static int64_t nowNs() noexcept;
+
+    /** The time the stamp's position was current. That's the host's time for the block
+        when it gave one that's plausibly on our clock, since it doesn't include however
+        long the block waited to be processed; otherwise it's when the stamp was published.
+    */
+    static int64_t getReferenceNs (const BeatStamp&) noexcept;
+
+    /** Extrapolates a stamp forward to the given time on the nowNs() clock. While stopped
+        the position doesn't move.
+    */
+    static double extrapolatePpq (const BeatStamp&, int64_t nowNs) noexcept;
+
+    /** Beat index within the bar and the 0..1 phase within that beat, at a PPQ position.
+        Beats are counted in the time signature's denominator, so 6/8 has six per bar.
+    */
+    static std::pair<int, double> getBeatAndPhase (const BeatStamp&, double ppq) noexcept;
+
+private:
+    std::atomic<uint32_t> sequence { 0 };
+    BeatStamp stamp;
+};
@@ -0,0 +1,54 @@
+#include "BeatPhaseDisplay.h"
+#include "BPM2TimeLookAndFeel.h"
+
+BeatPhaseDisplay::BeatPhaseDisplay (const BeatClock& c)
+    : clock (c),
+      vBlankAttachment (this, [this] { refresh(); })
+{
+    setOpaque (false);
+    setInterceptsMouseClicks (false, false);
+}
+
+void BeatPhaseDisplay::refresh()
+{
+    BeatStamp stamp;
+    if (! clock.read (stamp))
+        return;
+
+    const auto ppq = BeatClock::extrapolatePpq (stamp, BeatClock::nowNs());
+    const auto [beat, phase] = BeatClock::getBeatAndPhase (stamp, ppq);
+
+    const int newNumBeats = juce::jlimit (1, 16, stamp.timeSigNumerator);
+    const int cellWidth = getWidth() / newNumBeats;
+    const int newSweep = stamp.isPlaying ? juce::roundToInt (phase * cellWidth) : 0;
+    const int newBeat = stamp.isPlaying ? beat : -1;
+
+    if (newNumBeats == numBeats && newBeat == currentBeat && newSweep == sweepPixels && stamp.isPlaying == playing)
+        return;
+
+    numBeats = newNumBeats;
+    currentBeat = newBeat;
+    sweepPixels = newSweep;
+    playing = stamp.isPlaying;
+    repaint();
+}
+
+void BeatPhaseDisplay::paint (juce::Graphics& g)
+{
+    const int spacing = 3;
+    const int cellWidth = getWidth() / numBeats;
+
+    for (int i = 0; i < numBeats; ++i)
+    {
+        auto cell = juce::Rectangle<int> (i * cellWidth, 0, cellWidth - spacing, getHeight());
+
+        g.setColour (juce::Colour (Palette::panel));
+        g.fillRect (cell);
+
+        if (i == currentBeat)
+        {
+            g.setColour (juce::Colour (i == 0 ? Palette::accentBright : Palette::accent));
+            g.fillRect (cell.withWidth (juce::jmin (sweepPixels, cell.getWidth())));
+        }
+    }
+}
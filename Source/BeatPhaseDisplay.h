@@ -0,0 +1,28 @@
+#pragma once
+#include <JuceHeader.h>
+#include "BeatClock.h"
+
+/** Visual metronome: one cell per beat in the bar, with the current beat lit and a
+    sweep showing the phase within it.
+
+    The position is extrapolated from the processor's latest BeatStamp on every display
+    refresh, and the component only repaints when what it would draw has changed.
+*/
+class BeatPhaseDisplay : public juce::Component
+{
+public:
+    explicit BeatPhaseDisplay (const BeatClock&);
+
+    void paint (juce::Graphics&) override;
+
+private:
+    void refresh();
+
+    const BeatClock& clock;
+    juce::VBlankAttachment vBlankAttachment;
+
+    int numBeats = 4;
+    int currentBeat = -1;
+    int sweepPixels = 0;
+    bool playing = false;
+};
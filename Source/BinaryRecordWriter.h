@@ -0,0 +1,160 @@
+#pragma once
+#include <JuceHeader.h>
+#include <thread>
+
+/** One low-priority thread per process that flushes diagnostic records to disk. */
+struct DiagnosticsThread : public juce::TimeSliceThread
+{
+    DiagnosticsThread() : juce::TimeSliceThread ("BPM2Time diagnostics") { startThread (juce::Thread::Priority::low); }
+    ~DiagnosticsThread() override { stopThread (1000); }
+};
+
+/** Streams fixed-size records from the audio thread into a file without doing any I/O there.
+
+    push() copies a record into a preallocated lock-free ring and returns; the shared
+    DiagnosticsThread drains the ring to disk. If the disk can't keep up, records are
+    dropped and counted rather than ever blocking the caller.
+
+    The ring is only allocated the first time start() is called, and the writer only
+    holds on to the DiagnosticsThread between start() and stop(), so instances that never
+    log don't carry the ring around and processes that never log don't start the thread.
+*/
+template <typename Record>
+class BinaryRecordWriter : private juce::TimeSliceClient
+{
+public:
+    static_assert (std::is_trivially_copyable_v<Record>, "Records are written to disk as raw bytes");
+
+    explicit BinaryRecordWriter (int capacity)
+        : fifo (capacity)
+    {
+    }
+
+    ~BinaryRecordWriter() override
+    {
+        stop();
+    }
+
+    /** Message thread. Opens the file, writes an optional header and starts accepting records.
+        An existing file is never overwritten: a numbered sibling is used instead, and
+        getFile() says which one.
+    */
+    bool start (const juce::File& file, const void* header = nullptr, size_t headerSize = 0)
+    {
+        stop();
+
+        currentFile = file.getNonexistentSibling();
+        auto newStream = std::make_unique<juce::FileOutputStream> (currentFile);
+
+        if (! newStream->openedOk())
+            return false;
+
+        if (header != nullptr && headerSize > 0)
+            newStream->write (header, headerSize);
+
+        // Nothing can be pushing yet: stop() waited for any push() in progress to finish,
+        // and push() does nothing until active is set below
+        if (records.empty())
+            records.resize ((size_t) fifo.getTotalSize());
+
+        stream = std::move (newStream);
+        fifo.reset();
+        numDropped = 0;
+        active = true;
+        thread.emplace();
+        (*thread)->addTimeSliceClient (this);
+        return true;
+    }
+
+    /** Message thread. Stops accepting records, flushes what's left and closes the file. */
+    void stop()
+    {
+        if (! active.exchange (false))
+            return;
+
+        // A push() that saw active before it was cleared may still be writing to the ring
+        while (pushesInProgress.load() != 0)
+            std::this_thread::yield();
+
+        (*thread)->removeTimeSliceClient (this);
+        thread.reset();
+        drain();
+        stream.reset();
+    }
+
+    bool isActive() const noexcept { return active.load (std::memory_order_relaxed); }
+    int getNumDropped() const noexcept { return numDropped.load (std::memory_order_relaxed); }
+    const juce::File& getFile() const noexcept { return currentFile; }
+
+    /** Audio thread. */
+    void push (const Record& record) noexcept
+    {
+        if (! isActive())
+            return;
+
+        // Announce the write before checking again, so stop() either sees it coming and
+        // waits, or has already cleared active and this push backs out
+        pushesInProgress.fetch_add (1);
+
+        if (active.load())
+        {
+            const auto scope = fifo.write (1);
+
+            if (scope.blockSize1 > 0)
+                records[(size_t) scope.startIndex1] = record;
+            else
+                numDropped.fetch_add (1, std::memory_order_relaxed);
+        }
+
+        pushesInProgress.fetch_sub (1, std::memory_order_release);
+    }
+
+protected:
+    /** Called on the writer thread after each batch, with the stream that was just written to.
+        A subclass that overrides this must call stop() in its own destructor, because by
+        the time the base class destructor runs the override is already gone.
+    */
+    virtual void didWrite (juce::FileOutputStream&) {}
+
+    std::unique_ptr<juce::FileOutputStream> stream;
+
+private:
+    int useTimeSlice() override
+    {
+        return drain() > 0 ? 5 : 50;
+    }
+
+    int drain()
+    {
+        if (stream == nullptr)
+            return 0;
+
+        const auto scope = fifo.read (fifo.getNumReady());
+
+        if (scope.blockSize1 > 0)
+            stream->write (records.data() + scope.startIndex1, (size_t) scope.blockSize1 * sizeof (Record));
+
+        if (scope.blockSize2 > 0)
+            stream->write (records.data() + scope.startIndex2, (size_t) scope.blockSize2 * sizeof (Record));
+
+        const int numWritten = scope.blockSize1 + scope.blockSize2;
+
+        if (numWritten > 0)
+        {
+            stream->flush();
+            didWrite (*stream);
+        }
+
+        return numWritten;
+    }
+
+    std::optional<juce::SharedResourcePointer<DiagnosticsThread>> thread;
+    juce::AbstractFifo fifo;
+    std::vector<Record> records;
+    juce::File currentFile;
+    std::atomic<bool> active { false };
+    std::atomic<int> pushesInProgress { 0 };
+    std::atomic<int> numDropped { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (BinaryRecordWriter)
+};
@@ -0,0 +1,150 @@
+#include "ClockOutputGenerator.h"
+
+namespace
+{
+    // Written as plain loops over contiguous floats so the compiler can vectorise them
+    void fillPhase (float* dest, int numSamples, float start, float increment) noexcept
+    {
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float x = start + increment * (float) i;
+            dest[i] = x - std::floor (x);
+        }
+    }
+
+    void fillGate (float* dest, const float* phase, int numSamples, float threshold) noexcept
+    {
+        for (int i = 0; i < numSamples; ++i)
+            dest[i] = phase[i] < threshold ? 1.0f : 0.0f;
+    }
+
+    double fractionalPart (double x) noexcept
+    {
+        return x - std::floor (x);
+    }
+}
+
+void ClockOutputGenerator::prepare (double newSampleRate, int maximumBlockSize)
+{
+    sampleRate = newSampleRate;
+    scratch.assign ((size_t) juce::jmax (1, maximumBlockSize), 0.0f);
+    reset();
+}
+
+void ClockOutputGenerator::reset() noexcept
+{
+    haveNextPpq = false;
+}
+
+void ClockOutputGenerator::process (juce::AudioBuffer<float>& clockBus,
+                                    const juce::Optional<juce::AudioPlayHead::PositionInfo>& position,
+                                    double fallbackBpm,
+                                    int divisionDenominator) noexcept
+{
+    const int numSamples = clockBus.getNumSamples();
+    const int numChannels = clockBus.getNumChannels();
+
+    clockBus.clear();
+
+    if (numChannels == 0 || ! position.hasValue() || ! position->getIsPlaying() || scratch.empty())
+    {
+        haveNextPpq = false;
+        return;
+    }
+
+    const double bpm = position->getBpm().orFallback (fallbackBpm);
+    if (bpm <= 0.0 || sampleRate <= 0.0)
+        return;
+
+    // Anchor to the host when it tells us where we are, otherwise carry on from the last block
+    double ppq = 0.0;
+    if (auto hostPpq = position->getPpqPosition())
+        ppq = *hostPpq;
+    else if (haveNextPpq)
+        ppq = nextPpq;
+
+    BlockTiming timing;
+    timing.ppqPerSample = bpm / (60.0 * sampleRate);
+    timing.divisionQuarters = 4.0 / (double) juce::jmax (1, divisionDenominator);
+    timing.barStartPpq = position->getPpqPositionOfLastBarStart().orFallback (0.0);
+
+    if (auto sig = position->getTimeSignature())
+        if (sig->numerator > 0 && sig->denominator > 0)
+            timing.barQuarters = sig->numerator * 4.0 / (double) sig->denominator;
+
+    const double quarterMs = 60000.0 / bpm;
+    timing.pulseFraction    = (float) juce::jmin (0.5, pulseLengthMs / (timing.divisionQuarters * quarterMs));
+    timing.barPulseFraction = (float) juce::jmin (0.5, pulseLengthMs / (timing.barQuarters * quarterMs));
+
+    float* pulse = clockBus.getWritePointer (0);
+    float* ramp  = numChannels > 1 ? clockBus.getWritePointer (1) : nullptr;
+    float* bar   = numChannels > 2 ? clockBus.getWritePointer (2) : nullptr;
+
+    // Split the block where a loop wraps back round
+    int start = 0;
+    if (position->getIsLooping())
+    {
+        if (auto loop = position->getLoopPoints(); loop.hasValue() && loop->ppqEnd > loop->ppqStart)
+        {
+            const double samplesToLoopEnd = (loop->ppqEnd - ppq) / timing.ppqPerSample;
+
+            if (samplesToLoopEnd >= 0.0 && samplesToLoopEnd < numSamples)
+            {
+                const int wrapAt = (int) std::ceil (samplesToLoopEnd);
+                renderSpan (pulse, ramp, bar, wrapAt, ppq, timing);
+
+                start = wrapAt;
+                ppq = loop->ppqStart + (wrapAt - samplesToLoopEnd) * timing.ppqPerSample;
+                timing.barStartPpq = std::floor ((loop->ppqStart - timing.barStartPpq) / timing.barQuarters)
+                                       * timing.barQuarters + timing.barStartPpq;
+            }
+        }
+    }
+
+    renderSpan (pulse + start,
+                ramp != nullptr ? ramp + start : nullptr,
+                bar != nullptr ? bar + start : nullptr,
+                numSamples - start, ppq, timing);
+
+    nextPpq = ppq + (numSamples - start) * timing.ppqPerSample;
+    haveNextPpq = true;
+}
+
+void ClockOutputGenerator::renderSpan (float* pulse, float* ramp, float* bar, int numSamples,
+                                       double startPpq, const BlockTiming& t) noexcept
+{
+    // A host can send a bigger block than it prepared us for, so go a scratch buffer at a time
+    const int chunkSize = (int) scratch.size();
+
+    for (int done = 0; done < numSamples; done += chunkSize)
+    {
+        renderChunk (pulse + done,
+                     ramp != nullptr ? ramp + done : nullptr,
+                     bar != nullptr ? bar + done : nullptr,
+                     juce::jmin (chunkSize, numSamples - done),
+                     startPpq + done * t.ppqPerSample, t);
+    }
+}
+
+void ClockOutputGenerator::renderChunk (float* pulse, float* ramp, float* bar, int numSamples,
+                                        double startPpq, const BlockTiming& t) noexcept
+{
+    jassert (numSamples <= (int) scratch.size());
+
+    // Phases are reduced in double precision first so the per-sample float maths stays
+    // accurate however far into the song we are
+    if (ramp != nullptr)
+        fillPhase (ramp, numSamples, (float) fractionalPart (startPpq), (float) t.ppqPerSample);
+
+    auto* divisionPhase = scratch.data();
+    fillPhase (divisionPhase, numSamples, (float) fractionalPart (startPpq / t.divisionQuarters),
+               (float) (t.ppqPerSample / t.divisionQuarters));
+    fillGate (pulse, divisionPhase, numSamples, t.pulseFraction);
+
+    if (bar != nullptr)
+    {
+        fillPhase (bar, numSamples, (float) fractionalPart ((startPpq - t.barStartPpq) / t.barQuarters),
+                   (float) (t.ppqPerSample / t.barQuarters));
+        fillGate (bar, bar, numSamples, t.barPulseFraction);
+    }
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <JuceHeader.h>
+
+/** Renders audio-rate sync signals for modular gear and hardware sequencers.
+
+    Channel 0 carries a clock pulse at the selected division, channel 1 a 0..1 ramp
+    across each beat and channel 2 a pulse at the start of each bar. Buses with fewer
+    channels just get the first ones.
+
+    Everything is derived from the host PPQ at the start of each block, so the output
+    re-anchors to the host every block and can't drift. Inside a block the tempo is
+    treated as constant, which keeps a ramp within one block's worth of the host curve.
+    A loop wrap inside the block is rendered as a jump back to the loop start, and a block
+    bigger than the size given to prepare() is rendered a piece at a time.
+*/
+class ClockOutputGenerator
+{
+public:
+    void prepare (double sampleRate, int maximumBlockSize);
+    void reset() noexcept;
+
+    void process (juce::AudioBuffer<float>& clockBus,
+                  const juce::Optional<juce::AudioPlayHead::PositionInfo>& position,
+                  double fallbackBpm,
+                  int divisionDenominator) noexcept;
+
+    static constexpr double pulseLengthMs = 5.0;
+
+private:
+    struct BlockTiming
+    {
+        double ppqPerSample = 0.0;
+        double divisionQuarters = 0.25;
+        double barQuarters = 4.0;
+        double barStartPpq = 0.0;
+        float pulseFraction = 0.5f;    // Share of a division the clock pulse stays high for
+        float barPulseFraction = 0.5f;
+    };
+
+    void renderSpan (float* pulse, float* ramp, float* bar, int numSamples, double startPpq, const BlockTiming&) noexcept;
+    void renderChunk (float* pulse, float* ramp, float* bar, int numSamples, double startPpq, const BlockTiming&) noexcept;
+
+    double sampleRate = 44100.0;
+    std::vector<float> scratch;
+
+    double nextPpq = 0.0;
+    bool haveNextPpq = false;
+};
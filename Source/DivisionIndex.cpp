@@ -0,0 +1,130 @@
+#include "DivisionIndex.h"
+
+namespace
+{
+    constexpr std::array<DivisionIndex::Variant, 3> variants { DivisionIndex::Variant::straight,
+                                                               DivisionIndex::Variant::dotted,
+                                                               DivisionIndex::Variant::triplet };
+
+    int numBpmSteps()
+    {
+        return juce::roundToInt ((DivisionIndex::maxBpm - DivisionIndex::minBpm) / DivisionIndex::bpmStep) + 1;
+    }
+}
+
+juce::String DivisionIndex::Match::getDivisionName() const
+{
+    auto name = "1/" + juce::String (denominator);
+
+    switch (variant)
+    {
+        case Variant::dotted:   return name + ".";
+        case Variant::triplet:  return name + "T";
+        case Variant::straight: break;
+    }
+
+    return name;
+}
+
+double DivisionIndex::getDurationMs (double bpm, int denominator, Variant variant) noexcept
+{
+    const double straightMs = (60000.0 / bpm) * (4.0 / static_cast<double> (denominator));
+
+    switch (variant)
+    {
+        case Variant::dotted:   return straightMs * 1.5;
+        case Variant::triplet:  return straightMs * 2.0 / 3.0;
+        case Variant::straight: break;
+    }
+
+    return straightMs;
+}
+
+DivisionIndex::DivisionIndex()
+    : juce::Thread ("BPM2Time division index")
+{
+    startThread (juce::Thread::Priority::low);
+}
+
+DivisionIndex::~DivisionIndex()
+{
+    stopThread (1000);
+}
+
+void DivisionIndex::run()
+{
+    static_assert (variants.size() * TempoMap::numDivisions == numRuns, "One run per division and variant");
+
+    const int steps = numBpmSteps();
+    entries.reserve ((size_t) steps * numRuns);
+
+    for (int d = 0; d < TempoMap::numDivisions; ++d)
+    {
+        for (auto variant : variants)
+        {
+            if (threadShouldExit())
+                return;
+
+            // Durations get shorter as the tempo goes up, so go down from the top of the range
+            for (int step = steps - 1; step >= 0; --step)
+            {
+                const double bpm = minBpm + step * bpmStep;
+                entries.push_back ({ (float) getDurationMs (bpm, TempoMap::divisionDenominators[(size_t) d], variant),
+                                     (uint16_t) step, (uint8_t) d, variant });
+            }
+        }
+    }
+
+    ready.store (true, std::memory_order_release);
+    builtEvent.signal();
+}
+
+DivisionIndex::Match DivisionIndex::toMatch (const Entry& e) const
+{
+    Match m;
+    m.bpm = minBpm + e.bpmStepIndex * bpmStep;
+    m.denominator = TempoMap::divisionDenominators[e.divisionIndex];
+    m.variant = e.variant;
+
+    // Report the exact duration rather than the float stored for searching
+    m.durationMs = getDurationMs (m.bpm, m.denominator, m.variant);
+    return m;
+}
+
+std::vector<DivisionIndex::Match> DivisionIndex::findNearest (double targetMs, int maxResults, double toleranceMs) const
+{
+    std::vector<Match> results;
+    if (maxResults <= 0 || ! isReady())
+        return results;
+
+    const auto target = (float) targetMs;
+    const auto runLength = (size_t) numBpmSteps();
+
+    // The closest tempo for each division, from whichever neighbour of the insertion point is nearer
+    for (size_t run = 0; run < numRuns; ++run)
+    {
+        const auto first = entries.begin() + (std::ptrdiff_t) (run * runLength);
+        const auto last = first + (std::ptrdiff_t) runLength;
+
+        auto it = std::lower_bound (first, last, target,
+                                    [] (const Entry& e, float t) { return e.durationMs < t; });
+
+        if (it == last || (it != first && targetMs - std::prev (it)->durationMs <= it->durationMs - targetMs))
+            --it;
+
+        auto match = toMatch (*it);
+
+        if (std::abs (match.durationMs - targetMs) <= toleranceMs)
+            results.push_back (match);
+    }
+
+    std::sort (results.begin(), results.end(), [targetMs] (const Match& a, const Match& b)
+    {
+        return std::abs (a.durationMs - targetMs) < std::abs (b.durationMs - targetMs);
+    });
+
+    if ((int) results.size() > maxResults)
+        results.resize ((size_t) maxResults);
+
+    return results;
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include <JuceHeader.h>
+#include "TempoMap.h"
+
+/** Reverse lookup from a target time to the tempo and note division that produce it.
+
+    Holds every (duration, BPM, division) combination across the manual BPM range in
+    0.01 steps, for straight, dotted and triplet versions of each division, with each
+    division's entries sorted by duration. The table is shared by every editor in the
+    process. Building it takes several milliseconds, more on a slow machine, so
+    construction starts a low-priority thread to build it and queries find nothing until
+    isReady(); a query is then a binary search in each division.
+*/
+class DivisionIndex : private juce::Thread
+{
+public:
+    DivisionIndex();
+    ~DivisionIndex() override;
+
+    enum class Variant : uint8_t { straight, dotted, triplet };
+
+    struct Match
+    {
+        double durationMs = 0.0;
+        double bpm = 0.0;
+        int denominator = 4;
+        Variant variant = Variant::straight;
+
+        juce::String getDivisionName() const;
+    };
+
+    static constexpr double minBpm = 20.0;
+    static constexpr double maxBpm = 300.0;
+    static constexpr double bpmStep = 0.01;
+
+    /** True once the table has been built. Until then every query comes back empty. */
+    bool isReady() const noexcept { return ready.load (std::memory_order_acquire); }
+
+    /** Blocks until the table has been built, or the timeout runs out. */
+    bool waitUntilReady (int timeoutMs) const { return isReady() || builtEvent.wait (timeoutMs); }
+
+    /** Up to maxResults combinations closest to targetMs, nearest first, all within toleranceMs.
+        Each division appears at most once, at the tempo that comes closest.
+    */
+    std::vector<Match> findNearest (double targetMs, int maxResults, double toleranceMs) const;
+
+    size_t getNumEntries() const noexcept { return isReady() ? entries.size() : 0; }
+    size_t getMemoryBytes() const noexcept { return isReady() ? entries.capacity() * sizeof (Entry) : 0; }
+
+private:
+    struct Entry
+    {
+        float durationMs;
+        uint16_t bpmStepIndex;
+        uint8_t divisionIndex;
+        Variant variant;
+    };
+
+    static_assert (sizeof (Entry) == 8, "Keep index entries compact");
+
+    // One run of entries per division and variant, each covering the whole BPM range
+    static constexpr size_t numRuns = (size_t) TempoMap::numDivisions * 3;
+
+    void run() override;
+    static double getDurationMs (double bpm, int denominator, Variant) noexcept;
+    Match toMatch (const Entry&) const;
+
+    // Written only by the build thread, and only read once ready is set
+    std::vector<Entry> entries;
+    std::atomic<bool> ready { false };
+    juce::WaitableEvent builtEvent { true };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DivisionIndex)
+};
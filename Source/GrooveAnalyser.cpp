@@ -0,0 +1,195 @@
+#include "GrooveAnalyser.h"
+
+namespace
+{
+    constexpr double onsetRatio = 4.0;          // ~6 dB jump over the slow average
+    constexpr double energyFloor = 1.0e-4;      // Ignore anything below about -40 dBFS
+    constexpr double slowTimeConstantMs = 150.0;
+    constexpr double refractoryMs = 60.0;
+
+    // Element by element, with nothing carried between iterations, so the compiler can
+    // vectorise it
+    void addSquares (float* energy, const float* data, int numSamples) noexcept
+    {
+        for (int i = 0; i < numSamples; ++i)
+            energy[i] += data[i] * data[i];
+    }
+
+    // A single running float total can't be vectorised without reordering the additions,
+    // which the compiler won't do unless told precision doesn't matter. Keeping one partial
+    // sum per lane gives it independent chains it can put in a vector register.
+    float sum (const float* data, int numSamples) noexcept
+    {
+        constexpr int numLanes = 8;
+        std::array<float, numLanes> lanes {};
+
+        int i = 0;
+        for (; i + numLanes <= numSamples; i += numLanes)
+            for (int lane = 0; lane < numLanes; ++lane)
+                lanes[(size_t) lane] += data[i + lane];
+
+        float total = 0.0f;
+        for (; i < numSamples; ++i)
+            total += data[i];
+
+        for (auto lane : lanes)
+            total += lane;
+
+        return total;
+    }
+
+    int firstSampleAtLeast (const float* energy, int numSamples, float threshold) noexcept
+    {
+        for (int i = 0; i < numSamples; ++i)
+            if (energy[i] >= threshold)
+                return i;
+
+        return 0;
+    }
+}
+
+void GrooveAnalyser::prepare (double newSampleRate)
+{
+    sampleRate = newSampleRate;
+
+    const double hopsPerTimeConstant = slowTimeConstantMs * 0.001 * sampleRate / hopSize;
+    slowCoefficient = 1.0 - std::exp (-1.0 / hopsPerTimeConstant);
+    refractorySamples = (int) (refractoryMs * 0.001 * sampleRate);
+
+    reset();
+}
+
+void GrooveAnalyser::reset() noexcept
+{
+    slowEnergy = 0.0;
+    samplesUntilArmed = 0;
+}
+
+void GrooveAnalyser::process (const juce::AudioBuffer<float>& buffer, int numChannels,
+                              const juce::AudioPlayHead::PositionInfo& pos, int divisionDenominator) noexcept
+{
+    const int numSamples = buffer.getNumSamples();
+    numChannels = juce::jmin (numChannels, buffer.getNumChannels());
+
+    auto ppq = pos.getPpqPosition();
+    auto bpm = pos.getBpm();
+
+    if (numChannels <= 0 || ! pos.getIsPlaying() || ! ppq.hasValue() || ! bpm.hasValue() || *bpm <= 0.0)
+    {
+        reset();
+        return;
+    }
+
+    const double ppqPerSample = *bpm / (60.0 * sampleRate);
+    const double gridQuarters = 4.0 / (double) juce::jmax (1, divisionDenominator);
+
+    for (int start = 0; start < numSamples; start += hopSize)
+    {
+        const int length = juce::jmin (hopSize, numSamples - start);
+
+        // Energy per sample, summed across channels so a hit panned to one side is found as
+        // well. The hop's energy is the total, and a hit is refined against the same values.
+        std::array<float, hopSize> sampleEnergy {};
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            addSquares (sampleEnergy.data(), buffer.getReadPointer (ch, start), length);
+
+        const float energy = sum (sampleEnergy.data(), length);
+        const double meanEnergy = energy / (double) (length * numChannels);
+
+        const bool isOnset = samplesUntilArmed <= 0
+                          && meanEnergy > energyFloor
+                          && meanEnergy > onsetRatio * slowEnergy;
+
+        if (isOnset)
+        {
+            // Refine to the first sample in the hop that reaches the hop's average energy
+            const int offset = firstSampleAtLeast (sampleEnergy.data(), length, energy / (float) length);
+
+            reportHit (start + offset, *ppq, ppqPerSample, *bpm, gridQuarters);
+            samplesUntilArmed = refractorySamples;
+        }
+
+        samplesUntilArmed -= length;
+        slowEnergy += slowCoefficient * (meanEnergy - slowEnergy);
+    }
+}
+
+void GrooveAnalyser::reportHit (int sampleInBlock, double blockPpq, double ppqPerSample, double bpm, double gridQuarters) noexcept
+{
+    const double ppq = blockPpq + sampleInBlock * ppqPerSample;
+    const double nearestLine = std::round (ppq / gridQuarters) * gridQuarters;
+    const double offsetQuarters = ppq - nearestLine;
+    const double offsetMs = offsetQuarters * 60000.0 / bpm;
+
+    GrooveHit hit;
+    hit.ppqPosition = ppq;
+    hit.offsetMs = (float) offsetMs;
+    hit.offsetSamples = (float) (offsetMs * 0.001 * sampleRate);
+    hit.gridFraction = (float) (offsetQuarters / gridQuarters);
+
+    const auto scope = fifo.write (1);
+
+    if (scope.blockSize1 > 0)
+        hits[(size_t) scope.startIndex1] = hit;
+}
+
+//==============================================================================
+int GrooveHistogram::binFor (float gridFraction) noexcept
+{
+    const auto bin = (int) std::floor ((gridFraction + 0.5f) * (float) numBins);
+    return juce::jlimit (0, numBins - 1, bin);
+}
+
+void GrooveHistogram::add (const GrooveHit& hit)
+{
+    auto& slot = history[(size_t) nextIndex];
+
+    if (numHits == historySize)
+    {
+        --bins[(size_t) binFor (slot.gridFraction)];
+        sumMs -= slot.offsetMs;
+        sumSquaresMs -= (double) slot.offsetMs * slot.offsetMs;
+    }
+    else
+    {
+        ++numHits;
+    }
+
+    slot = hit;
+    ++bins[(size_t) binFor (hit.gridFraction)];
+    sumMs += hit.offsetMs;
+    sumSquaresMs += (double) hit.offsetMs * hit.offsetMs;
+
+    nextIndex = (nextIndex + 1) % historySize;
+    ++version;
+}
+
+void GrooveHistogram::clear()
+{
+    bins.fill (0);
+    nextIndex = 0;
+    numHits = 0;
+    sumMs = 0.0;
+    sumSquaresMs = 0.0;
+    ++version;
+}
+
+int GrooveHistogram::getMaxBinCount() const noexcept
+{
+    return *std::max_element (bins.begin(), bins.end());
+}
+
+float GrooveHistogram::getMeanOffsetMs() const noexcept
+{
+    return numHits > 0 ? (float) (sumMs / numHits) : 0.0f;
+}
+
+float GrooveHistogram::getSpreadMs() const noexcept
+{
+    if (numHits < 2)
+        return 0.0f;
+
+    const double mean = sumMs / numHits;
+    return (float) std::sqrt (juce::jmax (0.0, sumSquaresMs / numHits - mean * mean));
+}
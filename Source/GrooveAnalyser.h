@@ -0,0 +1,92 @@
+#pragma once
+#include <JuceHeader.h>
+
+/** One detected transient and how far it landed from the nearest grid line. */
+struct GrooveHit
+{
+    double ppqPosition = 0.0;
+    float offsetMs = 0.0f;          // Negative = early, positive = late
+    float offsetSamples = 0.0f;
+    float gridFraction = 0.0f;      // Offset as a fraction of the grid spacing, -0.5..0.5
+};
+
+/** Finds transients in the audio passing through and measures them against the host grid.
+
+    The detector compares short-hop energy with a slow-moving average, then refines each
+    hit to the first sample in the hop that reaches the hop's average energy. Energy is
+    summed across all the channels, so a hit panned hard to either side is placed the
+    same way. The work per block is bounded and linear in the block size, with no
+    allocation after prepare(). Hits are handed to the message thread through a
+    lock-free FIFO.
+*/
+class GrooveAnalyser
+{
+public:
+    void prepare (double sampleRate);
+    void reset() noexcept;
+
+    /** Audio thread. */
+    void process (const juce::AudioBuffer<float>&, int numChannels,
+                  const juce::AudioPlayHead::PositionInfo&, int divisionDenominator) noexcept;
+
+    /** Message thread. Calls the callback for every hit queued since the last call. */
+    template <typename Callback>
+    void popHits (Callback&& callback)
+    {
+        const auto scope = fifo.read (fifo.getNumReady());
+
+        for (int i = 0; i < scope.blockSize1; ++i)
+            callback (hits[(size_t) (scope.startIndex1 + i)]);
+
+        for (int i = 0; i < scope.blockSize2; ++i)
+            callback (hits[(size_t) (scope.startIndex2 + i)]);
+    }
+
+    static constexpr int hopSize = 64;
+
+private:
+    void reportHit (int sampleInBlock, double blockPpq, double ppqPerSample, double bpm, double gridQuarters) noexcept;
+
+    double sampleRate = 44100.0;
+    double slowEnergy = 0.0;
+    double slowCoefficient = 0.0;
+    int refractorySamples = 0;
+    int samplesUntilArmed = 0;
+
+    // The message thread advances the queue's read index in popHits(), so it's kept off
+    // the line holding the detector state above, which process() writes on every block
+    static constexpr int fifoSize = 256;
+    alignas (128) juce::AbstractFifo fifo { fifoSize };
+    std::array<GrooveHit, fifoSize> hits;
+};
+
+/** Rolling histogram of the most recent hits' grid offsets. Message thread only. */
+class GrooveHistogram
+{
+public:
+    static constexpr int numBins = 21;
+    static constexpr int historySize = 256;
+
+    void add (const GrooveHit&);
+    void clear();
+
+    int getBinCount (int bin) const noexcept { return bins[(size_t) bin]; }
+    int getMaxBinCount() const noexcept;
+    int getNumHits() const noexcept { return numHits; }
+    float getMeanOffsetMs() const noexcept;
+    float getSpreadMs() const noexcept;
+
+    /** Bumped on every change, so viewers can skip repainting when nothing happened. */
+    uint32_t getVersion() const noexcept { return version; }
+
+private:
+    static int binFor (float gridFraction) noexcept;
+
+    std::array<GrooveHit, historySize> history {};
+    std::array<int, numBins> bins {};
+    int nextIndex = 0;
+    int numHits = 0;
+    double sumMs = 0.0;
+    double sumSquaresMs = 0.0;
+    uint32_t version = 0;
+};
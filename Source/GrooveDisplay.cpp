@@ -0,0 +1,60 @@
+#include "GrooveDisplay.h"
+
+GrooveDisplay::GrooveDisplay (const GrooveHistogram& h)
+    : histogram (h)
+{
+    setInterceptsMouseClicks (false, false);
+}
+
+void GrooveDisplay::refresh()
+{
+    if (histogram.getVersion() == lastVersion)
+        return;
+
+    lastVersion = histogram.getVersion();
+    repaint();
+}
+
+void GrooveDisplay::paint (juce::Graphics& g)
+{
+    auto bounds = getLocalBounds();
+    auto textArea = bounds.removeFromRight (220);
+
+    g.setColour (juce::Colour (Palette::panelDark));
+    g.fillRect (bounds);
+
+    const int maxCount = histogram.getMaxBinCount();
+    const float binWidth = (float) bounds.getWidth() / (float) GrooveHistogram::numBins;
+
+    if (maxCount > 0)
+    {
+        g.setColour (juce::Colour (Palette::accent));
+
+        for (int i = 0; i < GrooveHistogram::numBins; ++i)
+        {
+            const float height = (float) bounds.getHeight() * (float) histogram.getBinCount (i) / (float) maxCount;
+            g.fillRect (bounds.getX() + i * binWidth + 1.0f, (float) bounds.getBottom() - height, binWidth - 2.0f, height);
+        }
+    }
+
+    g.setColour (juce::Colour (Palette::divider));
+    g.drawVerticalLine (bounds.getCentreX(), (float) bounds.getY(), (float) bounds.getBottom());
+
+    juce::String text;
+
+    if (histogram.getNumHits() == 0)
+    {
+        text = "No hits yet";
+    }
+    else
+    {
+        const float mean = histogram.getMeanOffsetMs();
+        text = juce::String (std::abs (mean), 1) + " ms " + (mean < 0.0f ? "early" : "late")
+             + "  •  ±" + juce::String (histogram.getSpreadMs(), 1) + " ms"
+             + "  •  " + juce::String (histogram.getNumHits()) + " hits";
+    }
+
+    g.setColour (juce::Colours::lightgrey);
+    g.setFont (lookAndFeel->statusFont);
+    g.drawText (text, textArea.reduced (8, 0), juce::Justification::centredLeft);
+}
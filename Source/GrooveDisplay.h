@@ -0,0 +1,23 @@
+#pragma once
+#include <JuceHeader.h>
+#include "BPM2TimeLookAndFeel.h"
+#include "GrooveAnalyser.h"
+
+/** Draws the rolling groove histogram: early hits to the left of the centre line,
+    late hits to the right, with the mean offset and spread written underneath.
+*/
+class GrooveDisplay : public juce::Component
+{
+public:
+    explicit GrooveDisplay (const GrooveHistogram&);
+
+    /** Repaints if the histogram has changed since the last call. */
+    void refresh();
+
+    void paint (juce::Graphics&) override;
+
+private:
+    const GrooveHistogram& histogram;
+    juce::SharedResourcePointer<BPM2TimeLookAndFeel> lookAndFeel;
+    uint32_t lastVersion = 0;
+};
@@ -0,0 +1,150 @@
+#include "PlayheadTrace.h"
+#include "PluginProcessor.h"
+
+namespace PlayheadTrace
+{
+
+Record encode (const juce::Optional<juce::AudioPlayHead::PositionInfo>& position, int numSamples) noexcept
+{
+    Record r;
+    r.numSamples = numSamples;
+
+    if (! position.hasValue())
+        return r;
+
+    const auto& pos = *position;
+    r.flags |= hasPosition;
+
+    if (pos.getIsPlaying())   r.flags |= isPlaying;
+    if (pos.getIsRecording()) r.flags |= isRecording;
+    if (pos.getIsLooping())   r.flags |= isLooping;
+
+    if (auto v = pos.getBpm())                        { r.flags |= hasBpm;           r.bpm = *v; }
+    if (auto v = pos.getPpqPosition())                { r.flags |= hasPpq;           r.ppqPosition = *v; }
+    if (auto v = pos.getPpqPositionOfLastBarStart())  { r.flags |= hasBarStart;      r.ppqOfLastBarStart = *v; }
+    if (auto v = pos.getTimeInSamples())              { r.flags |= hasTimeInSamples; r.timeInSamples = *v; }
+    if (auto v = pos.getTimeInSeconds())              { r.flags |= hasTimeInSeconds; r.timeInSeconds = *v; }
+    if (auto v = pos.getHostTimeNs())                 { r.flags |= hasHostTime;      r.hostTimeNs = *v; }
+
+    if (auto v = pos.getTimeSignature())
+    {
+        r.flags |= hasTimeSignature;
+        r.timeSigNumerator = (int16_t) v->numerator;
+        r.timeSigDenominator = (int16_t) v->denominator;
+    }
+
+    if (auto v = pos.getLoopPoints())
+    {
+        r.flags |= hasLoopPoints;
+        r.loopStartPpq = v->ppqStart;
+        r.loopEndPpq = v->ppqEnd;
+    }
+
+    return r;
+}
+
+juce::Optional<juce::AudioPlayHead::PositionInfo> decode (const Record& r) noexcept
+{
+    if ((r.flags & hasPosition) == 0)
+        return {};
+
+    juce::AudioPlayHead::PositionInfo pos;
+    pos.setIsPlaying ((r.flags & isPlaying) != 0);
+    pos.setIsRecording ((r.flags & isRecording) != 0);
+    pos.setIsLooping ((r.flags & isLooping) != 0);
+
+    if (r.flags & hasBpm)           pos.setBpm (r.bpm);
+    if (r.flags & hasPpq)           pos.setPpqPosition (r.ppqPosition);
+    if (r.flags & hasBarStart)      pos.setPpqPositionOfLastBarStart (r.ppqOfLastBarStart);
+    if (r.flags & hasTimeInSamples) pos.setTimeInSamples (r.timeInSamples);
+    if (r.flags & hasTimeInSeconds) pos.setTimeInSeconds (r.timeInSeconds);
+    if (r.flags & hasHostTime)      pos.setHostTimeNs (r.hostTimeNs);
+
+    if (r.flags & hasTimeSignature)
+        pos.setTimeSignature (juce::AudioPlayHead::TimeSignature { r.timeSigNumerator, r.timeSigDenominator });
+
+    if (r.flags & hasLoopPoints)
+        pos.setLoopPoints (juce::AudioPlayHead::LoopPoints { r.loopStartPpq, r.loopEndPpq });
+
+    return pos;
+}
+
+bool Capture::start (const juce::File& file, double sampleRate, int maxBlockSize, int numChannels)
+{
+    FileHeader h;
+    h.sampleRate = sampleRate;
+    h.maxBlockSize = maxBlockSize;
+    h.numChannels = numChannels;
+    return BinaryRecordWriter<Record>::start (file, &h, sizeof (h));
+}
+
+bool Replayer::load (const juce::File& file)
+{
+    records.clear();
+
+    juce::MemoryBlock data;
+    if (! file.loadFileAsData (data) || data.getSize() < sizeof (FileHeader))
+        return false;
+
+    std::memcpy (&header, data.getData(), sizeof (FileHeader));
+
+    if (header.magic != magic || header.version != version || header.sampleRate <= 0.0)
+        return false;
+
+    const auto numRecords = (data.getSize() - sizeof (FileHeader)) / sizeof (Record);
+    records.resize (numRecords);
+    std::memcpy (records.data(), static_cast<const char*> (data.getData()) + sizeof (FileHeader), numRecords * sizeof (Record));
+    return true;
+}
+
+juce::Optional<juce::AudioPlayHead::PositionInfo> Replayer::getPosition() const
+{
+    return currentRecord < records.size() ? decode (records[currentRecord]) : juce::Optional<PositionInfo>();
+}
+
+std::vector<Replayer::BlockResult> Replayer::replay (PassthroughTempoProcessor& processor)
+{
+    int maxBlockSize = header.maxBlockSize;
+    for (const auto& r : records)
+        maxBlockSize = juce::jmax (maxBlockSize, r.numSamples);
+
+    const int numChannels = juce::jmax (header.numChannels, processor.getTotalNumInputChannels(), processor.getTotalNumOutputChannels());
+
+    juce::AudioBuffer<float> buffer (numChannels, juce::jmax (1, maxBlockSize));
+    juce::MidiBuffer midi;
+
+    processor.setDeterministic (true);
+    processor.setPlayHead (this);
+    processor.setRateAndBufferSizeDetails (header.sampleRate, maxBlockSize);
+    processor.prepareToPlay (header.sampleRate, maxBlockSize);
+
+    std::vector<BlockResult> results;
+    results.reserve (records.size());
+
+    for (currentRecord = 0; currentRecord < records.size(); ++currentRecord)
+    {
+        const int numSamples = records[currentRecord].numSamples;
+        buffer.setSize (numChannels, numSamples, false, false, true);
+        buffer.clear();
+        midi.clear();
+
+        const auto startTicks = juce::Time::getHighResolutionTicks();
+        processor.processBlock (buffer, midi);
+        const auto endTicks = juce::Time::getHighResolutionTicks();
+
+        BlockResult result;
+        result.numSamples = numSamples;
+        result.effectiveBpm = processor.getEffectiveBpm();
+        result.cachedBpm = processor.getCachedBpm();
+        result.hostProvidedBpm = processor.hostProvidedBpm();
+        result.processMicroseconds = juce::Time::highResolutionTicksToSeconds (endTicks - startTicks) * 1.0e6;
+        results.push_back (result);
+    }
+
+    processor.releaseResources();
+    processor.setPlayHead (nullptr);
+    processor.setDeterministic (false);
+    return results;
+}
+
+}
@@ -0,0 +1,106 @@
+#pragma once
+#include <JuceHeader.h>
+#include "BinaryRecordWriter.h"
+
+class PassthroughTempoProcessor;
+
+/** Compact binary traces of everything processBlock saw from the host's playhead.
+
+    A trace file is a FileHeader followed by one Record per block. Capturing happens on
+    the audio thread without I/O (see Capture), and Replayer feeds a trace back into the
+    processor deterministically, recording what it did on each block.
+*/
+namespace PlayheadTrace
+{
+    constexpr uint32_t magic = 0x52545042;  // 'BPTR'
+    constexpr uint32_t version = 1;
+
+    struct FileHeader
+    {
+        uint32_t magic = PlayheadTrace::magic;
+        uint32_t version = PlayheadTrace::version;
+        double sampleRate = 0.0;
+        int32_t maxBlockSize = 0;
+        int32_t numChannels = 0;
+    };
+
+    enum Flags : uint32_t
+    {
+        hasPosition      = 1 << 0,
+        hasBpm           = 1 << 1,
+        hasPpq           = 1 << 2,
+        hasBarStart      = 1 << 3,
+        hasTimeSignature = 1 << 4,
+        hasTimeInSamples = 1 << 5,
+        hasTimeInSeconds = 1 << 6,
+        hasHostTime      = 1 << 7,
+        hasLoopPoints    = 1 << 8,
+        isPlaying        = 1 << 9,
+        isRecording      = 1 << 10,
+        isLooping        = 1 << 11
+    };
+
+    struct Record
+    {
+        uint32_t flags = 0;
+        int32_t numSamples = 0;
+        double bpm = 0.0;
+        double ppqPosition = 0.0;
+        double ppqOfLastBarStart = 0.0;
+        double timeInSeconds = 0.0;
+        int64_t timeInSamples = 0;
+        uint64_t hostTimeNs = 0;
+        double loopStartPpq = 0.0;
+        double loopEndPpq = 0.0;
+        int16_t timeSigNumerator = 0;
+        int16_t timeSigDenominator = 0;
+        uint32_t reserved = 0;
+    };
+
+    Record encode (const juce::Optional<juce::AudioPlayHead::PositionInfo>&, int numSamples) noexcept;
+    juce::Optional<juce::AudioPlayHead::PositionInfo> decode (const Record&) noexcept;
+
+    /** Writes a trace file from the audio thread. */
+    class Capture : public BinaryRecordWriter<Record>
+    {
+    public:
+        Capture() : BinaryRecordWriter<Record> (8192) {}
+
+        bool start (const juce::File&, double sampleRate, int maxBlockSize, int numChannels);
+    };
+
+    /** Loads a trace and plays it back through the processor, one recorded block at a time. */
+    class Replayer : private juce::AudioPlayHead
+    {
+    public:
+        bool load (const juce::File&);
+
+        const FileHeader& getHeader() const noexcept { return header; }
+        const std::vector<Record>& getRecords() const noexcept { return records; }
+
+        /** What the processor reported after one block. Everything but the timing is the
+            same on every replay of the same trace.
+        */
+        struct BlockResult
+        {
+            int numSamples = 0;
+            double effectiveBpm = 0.0;
+            double cachedBpm = 0.0;
+            bool hostProvidedBpm = false;
+            double processMicroseconds = 0.0;
+        };
+
+        /** Prepares the processor at the recorded settings in deterministic mode, runs every
+            block through it with silent audio and returns its state after each one. The
+            processor's playhead is restored to nullptr afterwards.
+        */
+        std::vector<BlockResult> replay (PassthroughTempoProcessor&);
+
+    private:
+        juce::Optional<PositionInfo> getPosition() const override;
+
+        FileHeader header;
+        std::vector<Record> records;
+        size_t currentRecord = 0;
+    };
+}
@@ -2,49 +2,22 @@
 #include "PluginProcessor.h"
 
 PassthroughTempoEditor::PassthroughTempoEditor (PassthroughTempoProcessor& p)
-    : AudioProcessorEditor (&p), processorRef (p)
+    : AudioProcessorEditor (&p), processorRef (p), beatDisplay (p.getBeatClock()),
+      grooveDisplay (p.getGrooveHistogram())
 {
-    struct BtnInfo { juce::TextButton* btn; int idx; };
-    std::vector<BtnInfo> btns {
-        { &b128, 0 }, { &b64, 1 }, { &b32, 2 }, { &b16, 3 },
-        { &b8, 4 }, { &b4, 5 }, { &b2, 6 }, { &b1, 7 }
-    };
+    setLookAndFeel (lookAndFeel.get());
 
-    for (auto& bi : btns)
+    for (size_t i = 0; i < divisionButtons.size(); ++i)
     {
-        addAndMakeVisible (*bi.btn);
-        bi.btn->setClickingTogglesState (true);
-        bi.btn->setColour (juce::TextButton::buttonColourId, juce::Colour (0xff2a2a2a));
-        bi.btn->setColour (juce::TextButton::buttonOnColourId, juce::Colour (0xff4a90e2));
-        bi.btn->setColour (juce::TextButton::textColourOffId, juce::Colours::lightgrey);
-        bi.btn->setColour (juce::TextButton::textColourOnId, juce::Colours::white);
-        
-        bi.btn->onClick = [this, idx = bi.idx, btn = bi.btn]()
-        {
-            if (! btn->getToggleState())
-            {
-                btn->setToggleState (true, juce::dontSendNotification);
-                return;
-            }
-            
-            // Force read BPM if sync is enabled
-            bool syncEnabled = false;
-            if (auto* pb = dynamic_cast<juce::AudioParameterBool*> (processorRef.apvts.getParameter ("syncBpm")))
-                syncEnabled = pb->get();
-            
-            if (syncEnabled)
-                processorRef.forceReadBpmFromHost();
-            
-            processorRef.setDivisionIndexNotifyingHost (idx);
-            updateUiFromParameters();
-            updateMsLabel();
-        };
+        auto& b = divisionButtons[i];
+        b.setButtonText ("1/" + juce::String (TempoMap::divisionDenominators[i]));
+        b.setClickingTogglesState (true);
+        b.setRadioGroupId (1);
+        b.addListener (this);
+        addAndMakeVisible (b);
     }
 
     addAndMakeVisible (syncToggle);
-    syncToggle.setColour (juce::ToggleButton::textColourId, juce::Colours::white);
-    syncToggle.setColour (juce::ToggleButton::tickColourId, juce::Colour (0xff4a90e2));
-    syncToggle.setColour (juce::ToggleButton::tickDisabledColourId, juce::Colours::darkgrey);
     
     syncToggle.onClick = [this]()
     {
@@ -59,12 +32,6 @@ PassthroughTempoEditor::PassthroughTempoEditor (PassthroughTempoProcessor& p)
     manualBpmSlider.setSliderStyle (juce::Slider::LinearHorizontal);
     manualBpmSlider.setTextBoxStyle (juce::Slider::TextBoxRight, false, 80, 20);
     manualBpmSlider.setRange (20.0, 300.0, 0.01);
-    manualBpmSlider.setColour (juce::Slider::trackColourId, juce::Colour (0xff4a4a4a));
-    manualBpmSlider.setColour (juce::Slider::thumbColourId, juce::Colour (0xff4a90e2));
-    manualBpmSlider.setColour (juce::Slider::backgroundColourId, juce::Colour (0xff1a1a1a));
-    manualBpmSlider.setColour (juce::Slider::textBoxTextColourId, juce::Colours::white);
-    manualBpmSlider.setColour (juce::Slider::textBoxBackgroundColourId, juce::Colour (0xff2a2a2a));
-    manualBpmSlider.setColour (juce::Slider::textBoxOutlineColourId, juce::Colours::transparentBlack);
     
     addAndMakeVisible (manualBpmSlider);
     manualBpmAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment> (
@@ -73,31 +40,52 @@ PassthroughTempoEditor::PassthroughTempoEditor (PassthroughTempoProcessor& p)
     addAndMakeVisible (bpmLabel);
     bpmLabel.setText ("BPM", juce::dontSendNotification);
     bpmLabel.setJustificationType (juce::Justification::centredLeft);
-    bpmLabel.setFont (juce::FontOptions (13.0f, juce::Font::bold));
-    bpmLabel.setColour (juce::Label::textColourId, juce::Colours::lightgrey);
+    bpmLabel.setFont (lookAndFeel->bpmFont);
 
     addAndMakeVisible (msLabel);
     msLabel.setJustificationType (juce::Justification::centred);
-    msLabel.setFont (juce::FontOptions (32.0f, juce::Font::bold));
-    msLabel.setColour (juce::Label::textColourId, juce::Colour (0xff4a90e2));
-    msLabel.setColour (juce::Label::backgroundColourId, juce::Colour (0xff1a1a1a));
+    msLabel.setFont (lookAndFeel->msFont);
+    msLabel.setColour (juce::Label::textColourId, juce::Colour (Palette::accent));
+    msLabel.setColour (juce::Label::backgroundColourId, juce::Colour (Palette::panelDark));
+
+    addAndMakeVisible (beatDisplay);
+
+    addAndMakeVisible (optionsButton);
+    optionsButton.onClick = [this] { showOptionsMenu(); };
 
     addAndMakeVisible (statusLabel);
     statusLabel.setJustificationType (juce::Justification::centred);
-    statusLabel.setFont (juce::FontOptions (12.0f));
+    statusLabel.setFont (lookAndFeel->statusFont);
     statusLabel.setColour (juce::Label::textColourId, juce::Colours::grey);
 
-    setSize (680, 250);
+    addAndMakeVisible (targetMsLabel);
+    targetMsLabel.setText ("Find ms", juce::dontSendNotification);
+    targetMsLabel.setFont (lookAndFeel->bpmFont);
+
+    addAndMakeVisible (targetMsEditor);
+    targetMsEditor.setInputRestrictions (8, "0123456789.");
+    targetMsEditor.setJustification (juce::Justification::centredLeft);
+    targetMsEditor.onTextChange = [this] { updateReverseLookup(); };
+
+    addAndMakeVisible (reverseResultsLabel);
+    reverseResultsLabel.setFont (lookAndFeel->statusFont);
+
+    addAndMakeVisible (grooveToggle);
+    grooveAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment> (
+        processorRef.apvts, "grooveAnalysis", grooveToggle);
+
+    addAndMakeVisible (grooveDisplay);
+
+    setSize (680, 336);
 
     // Force read BPM when plugin is opened if sync is enabled
-    bool syncEnabled = false;
-    if (auto* pb = dynamic_cast<juce::AudioParameterBool*> (processorRef.apvts.getParameter ("syncBpm")))
-        syncEnabled = pb->get();
-    
-    if (syncEnabled)
+    if (processorRef.isSyncEnabled())
         processorRef.forceReadBpmFromHost();
 
     updateUiFromParameters();
+
+    // Nothing drained the hit queue while the editor was closed, so what is in it is stale
+    processorRef.discardQueuedGrooveHits();
     startTimerHz (2);
 }
 
@@ -105,47 +93,86 @@ PassthroughTempoEditor::~PassthroughTempoEditor()
 {
     stopTimer();
     syncAttachment.reset();
+    grooveAttachment.reset();
     manualBpmAttachment.reset();
+    setLookAndFeel (nullptr);
+}
+
+void PassthroughTempoEditor::buttonClicked (juce::Button* button)
+{
+    // Clicking a division also turns the previous one off, which calls back here too
+    if (! button->getToggleState())
+        return;
+
+    for (size_t i = 0; i < divisionButtons.size(); ++i)
+    {
+        if (button != &divisionButtons[i])
+            continue;
+
+        // Force read BPM if sync is enabled
+        if (processorRef.isSyncEnabled())
+            processorRef.forceReadBpmFromHost();
+
+        processorRef.setDivisionIndexNotifyingHost ((int) i);
+        updateUiFromParameters();
+        updateMsLabel();
+        return;
+    }
 }
 
 void PassthroughTempoEditor::paint (juce::Graphics& g)
 {
-    g.fillAll (juce::Colour (0xff1e1e1e));
+    g.fillAll (juce::Colour (Palette::background));
     
     auto headerArea = getLocalBounds().removeFromTop (40);
-    g.setGradientFill (juce::ColourGradient (juce::Colour (0xff2a2a2a), 0, 0,
-                                             juce::Colour (0xff1a1a1a), 0, (float) headerArea.getBottom(),
+    g.setGradientFill (juce::ColourGradient (juce::Colour (Palette::panel), 0, 0,
+                                             juce::Colour (Palette::panelDark), 0, (float) headerArea.getBottom(),
                                              false));
     g.fillRect (headerArea);
     
-    g.setColour (juce::Colours::white);
-    g.setFont (juce::FontOptions (18.0f, juce::Font::bold));
-    g.drawText ("BPM to Time", headerArea.reduced (15, 0), juce::Justification::centredLeft);
-    
-    g.setColour (juce::Colour (0xff3a3a3a));
+    g.setColour (juce::Colour (Palette::divider));
     g.drawLine (0, 40, (float) getWidth(), 40, 1.0f);
     
+    g.setColour (juce::Colours::white);
+    lookAndFeel->drawStaticText (g, "BPM to Time", lookAndFeel->titleFont, titleArea, juce::Justification::centredLeft);
+
     g.setColour (juce::Colours::lightgrey);
-    g.setFont (juce::FontOptions (11.0f, juce::Font::bold));
-    g.drawText ("NOTE DIVISION", 15, 50, 150, 20, juce::Justification::centredLeft);
+    lookAndFeel->drawStaticText (g, "NOTE DIVISION", lookAndFeel->sectionFont, divisionCaptionArea, juce::Justification::centredLeft);
 }
 
 void PassthroughTempoEditor::resized()
 {
     auto bounds = getLocalBounds();
-    bounds.removeFromTop (40);
+    auto header = bounds.removeFromTop (40);
+    beatDisplay.setBounds (header.removeFromRight (215).withSizeKeepingCentre (200, 12));
+    optionsButton.setBounds (header.removeFromRight (80).withSizeKeepingCentre (70, 24));
+    titleArea = header.withTrimmedLeft (15);
     
     auto content = bounds.reduced (15, 10);
-    content.removeFromTop (20);
+
+    auto grooveRow = content.removeFromBottom (36);
+    grooveToggle.setBounds (grooveRow.removeFromLeft (120));
+    grooveRow.removeFromLeft (10);
+    grooveDisplay.setBounds (grooveRow);
+    content.removeFromBottom (10);
+
+    auto reverseRow = content.removeFromBottom (30);
+    targetMsLabel.setBounds (reverseRow.removeFromLeft (60));
+    targetMsEditor.setBounds (reverseRow.removeFromLeft (60).reduced (0, 3));
+    reverseRow.removeFromLeft (10);
+    reverseResultsLabel.setBounds (reverseRow);
+    content.removeFromBottom (10);
+
+    divisionCaptionArea = content.removeFromTop (20);
     
     auto btnArea = content.removeFromTop (50);
     int spacing = 8;
     int btnW = (btnArea.getWidth() - spacing * 7) / 8;
     int x = btnArea.getX();
     
-    for (auto* b : { &b128, &b64, &b32, &b16, &b8, &b4, &b2, &b1 })
+    for (auto& b : divisionButtons)
     {
-        b->setBounds (x, btnArea.getY(), btnW, btnArea.getHeight());
+        b.setBounds (x, btnArea.getY(), btnW, btnArea.getHeight());
         x += btnW + spacing;
     }
     
@@ -169,54 +196,151 @@ void PassthroughTempoEditor::resized()
 
 void PassthroughTempoEditor::timerCallback()
 {
+    processorRef.processQueuedAnalysis();
     updateUiFromParameters();
     updateMsLabel();
     updateManualBpmFromHost();
+    grooveDisplay.refresh();
+
+    if (reverseLookupPending)
+        updateReverseLookup();
 }
 
 void PassthroughTempoEditor::updateUiFromParameters()
 {
     int denom = processorRef.getSelectedDenominator();
 
-    b128.setToggleState (denom == 128, juce::dontSendNotification);
-    b64.setToggleState (denom == 64, juce::dontSendNotification);
-    b32.setToggleState (denom == 32, juce::dontSendNotification);
-    b16.setToggleState (denom == 16, juce::dontSendNotification);
-    b8.setToggleState  (denom == 8,  juce::dontSendNotification);
-    b4.setToggleState  (denom == 4,  juce::dontSendNotification);
-    b2.setToggleState  (denom == 2,  juce::dontSendNotification);
-    b1.setToggleState  (denom == 1,  juce::dontSendNotification);
-
-    bool sync = false;
-    if (auto* pb = dynamic_cast<juce::AudioParameterBool*> (processorRef.apvts.getParameter ("syncBpm")))
-        sync = pb->get();
-    manualBpmSlider.setEnabled (! sync);
+    for (size_t i = 0; i < divisionButtons.size(); ++i)
+        divisionButtons[i].setToggleState (TempoMap::divisionDenominators[i] == denom, juce::dontSendNotification);
+
+    manualBpmSlider.setEnabled (! processorRef.isSyncEnabled());
 }
 
 void PassthroughTempoEditor::updateManualBpmFromHost()
 {
-    // Get sync state
-    bool syncEnabled = false;
-    if (auto* pb = dynamic_cast<juce::AudioParameterBool*> (processorRef.apvts.getParameter ("syncBpm")))
-        syncEnabled = pb->get();
+    bool syncEnabled = processorRef.isSyncEnabled();
     
     // When sync is ON: Always update slider to show current host BPM
     // When sync is OFF: Don't update slider automatically (user controls it)
     if (syncEnabled && processorRef.hostProvidedBpm())
     {
-        double hostBpm = processorRef.cachedBpm;
+        double hostBpm = processorRef.getCachedBpm();
         if (hostBpm > 0.0 && ! manualBpmSlider.isMouseButtonDown())
         {
             // Update both the slider display AND the parameter value
             manualBpmSlider.setValue (hostBpm, juce::dontSendNotification);
             
-            // Also update the actual parameter so it's in sync
+            // Also update the actual parameter so it's in sync, but only write to the
+            // host when the value has actually moved
             if (auto* pf = processorRef.apvts.getParameter ("manualBpm"))
-                pf->setValueNotifyingHost (pf->convertTo0to1 ((float) hostBpm));
+            {
+                const float normalised = pf->convertTo0to1 ((float) hostBpm);
+                if (std::abs (pf->getValue() - normalised) > 1.0e-7f)
+                    pf->setValueNotifyingHost (normalised);
+            }
         }
     }
 }
 
+void PassthroughTempoEditor::showOptionsMenu()
+{
+    auto& apvts = processorRef.apvts;
+
+    auto setParameter = [&apvts] (const juce::String& paramID, float value)
+    {
+        if (auto* param = apvts.getParameter (paramID))
+            param->setValueNotifyingHost (param->convertTo0to1 (value));
+    };
+
+    const auto currentValue = [&apvts] (const juce::String& paramID)
+    {
+        return apvts.getRawParameterValue (paramID)->load();
+    };
+
+    // Tempo smoothing: how the host's reported tempo is cleaned up before it's used
+    juce::PopupMenu filterMenu;
+    const juce::StringArray filterNames { "None", "Median", "One-euro" };
+
+    for (int i = 0; i < filterNames.size(); ++i)
+        filterMenu.addItem (filterNames[i], true, juce::roundToInt (currentValue ("tempoFilter")) == i,
+                            [setParameter, i] { setParameter ("tempoFilter", (float) i); });
+
+    juce::PopupMenu deadbandMenu;
+
+    for (auto deadband : { 0.0f, 0.001f, 0.005f, 0.01f, 0.05f })
+        deadbandMenu.addItem (deadband > 0.0f ? juce::String (deadband, 3) + " BPM" : juce::String ("Off"), true,
+                              std::abs (currentValue ("tempoDeadband") - deadband) < 1.0e-6f,
+                              [setParameter, deadband] { setParameter ("tempoDeadband", deadband); });
+
+    juce::PopupMenu snapMenu;
+
+    for (int i = 0; i < (int) PassthroughTempoProcessor::tempoSnapResolutions.size(); ++i)
+    {
+        const auto resolution = PassthroughTempoProcessor::tempoSnapResolutions[(size_t) i];
+        snapMenu.addItem (resolution > 0.0 ? juce::String (resolution) + " BPM" : juce::String ("Off"), true,
+                          juce::roundToInt (currentValue ("tempoSnap")) == i,
+                          [setParameter, i] { setParameter ("tempoSnap", (float) i); });
+    }
+
+    juce::PopupMenu menu;
+    menu.addSectionHeader ("Tempo smoothing");
+    menu.addSubMenu ("Filter", filterMenu);
+    menu.addSubMenu ("Deadband", deadbandMenu);
+    menu.addSubMenu ("Snap to", snapMenu);
+
+    // Diagnostics: the tempo log, for when the ms value doesn't follow some host
+    const auto logDirectory = PassthroughTempoProcessor::getTempoLogDirectory();
+
+    menu.addSectionHeader ("Diagnostics");
+    menu.addItem ("Log tempo decisions", true, processorRef.isTempoLogging(), [&processor = processorRef, logDirectory]
+    {
+        if (processor.isTempoLogging())
+            processor.stopTempoLog();
+        else
+            processor.startTempoLog (logDirectory);
+    });
+
+    menu.addItem ("Show log folder", logDirectory.isDirectory(), false, [logDirectory] { logDirectory.revealToUser(); });
+
+    menu.showMenuAsync (juce::PopupMenu::Options().withTargetComponent (optionsButton));
+}
+
+void PassthroughTempoEditor::updateReverseLookup()
+{
+    const double targetMs = targetMsEditor.getText().getDoubleValue();
+    reverseLookupPending = false;
+
+    if (targetMs <= 0.0)
+    {
+        reverseResultsLabel.setText ({}, juce::dontSendNotification);
+        return;
+    }
+
+    if (! divisionIndex.has_value())
+        divisionIndex.emplace();
+
+    if (! (*divisionIndex)->isReady())
+    {
+        reverseResultsLabel.setText ("Building index...", juce::dontSendNotification);
+        reverseLookupPending = true;
+        return;
+    }
+
+    const auto matches = (*divisionIndex)->findNearest (targetMs, 4, 1.0);
+
+    if (matches.empty())
+    {
+        reverseResultsLabel.setText ("No tempo between 20 and 300 BPM hits that within 1 ms", juce::dontSendNotification);
+        return;
+    }
+
+    juce::StringArray parts;
+    for (const auto& m : matches)
+        parts.add (juce::String (m.bpm, 2) + " BPM " + m.getDivisionName());
+
+    reverseResultsLabel.setText (parts.joinIntoString ("  •  "), juce::dontSendNotification);
+}
+
 void PassthroughTempoEditor::updateMsLabel()
 {
     double effectiveBpm = processorRef.getEffectiveBpm();
@@ -229,17 +353,18 @@ void PassthroughTempoEditor::updateMsLabel()
         return;
     }
 
-    double quarterMs = 60000.0 / effectiveBpm;
-    double noteMs = quarterMs * (4.0 / static_cast<double> (denom));
-    
+    // When synced, the note is measured from the current position along the tempo curve
+    // so long notes over a ramp or tempo change show their real length
+    const double noteMs = processorRef.getCurrentDivisionMs();
+    const auto& tempoMap = processorRef.getTempoMap();
+    const auto ppq = processorRef.getLastPpqPosition();
+
     msLabel.setText (juce::String (noteMs, 2) + " ms", juce::dontSendNotification);
     
     // Display the BPM that's actually being used for calculation
     juce::String statusText = juce::String (effectiveBpm, 1) + " BPM  •  1/" + juce::String (denom) + " note";
     
-    bool syncEnabled = false;
-    if (auto* pb = dynamic_cast<juce::AudioParameterBool*> (processorRef.apvts.getParameter ("syncBpm")))
-        syncEnabled = pb->get();
+    bool syncEnabled = processorRef.isSyncEnabled();
     
     if (syncEnabled && processorRef.hostProvidedBpm())
         statusText += "  •  Synced to host";
@@ -247,6 +372,18 @@ void PassthroughTempoEditor::updateMsLabel()
         statusText += "  •  Waiting for host BPM";
     else
         statusText += "  •  Manual BPM";
+
+    // Preview the next tempo or metre change if the whole-song tempo map knows about one
+    if (auto* next = tempoMap.getNextChangeAfter (ppq))
+    {
+        statusText += "  •  Next: " + juce::String (next->bpm, 1) + " BPM";
+
+        if (auto* current = tempoMap.getSegmentAt (ppq))
+            if (next->timeSigNumerator != current->timeSigNumerator || next->timeSigDenominator != current->timeSigDenominator)
+                statusText += " " + juce::String (next->timeSigNumerator) + "/" + juce::String (next->timeSigDenominator);
+
+        statusText += " in " + juce::String (tempoMap.getBarsBetween (ppq, next->startPpq), 1) + " bars";
+    }
     
     statusLabel.setText (statusText, juce::dontSendNotification);
 }
@@ -1,8 +1,13 @@
 #pragma once
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
+#include "BeatPhaseDisplay.h"
+#include "BPM2TimeLookAndFeel.h"
+#include "DivisionIndex.h"
+#include "GrooveDisplay.h"
 
 class PassthroughTempoEditor : public juce::AudioProcessorEditor,
+                               private juce::Button::Listener,
                                private juce::Timer
 {
 public:
@@ -14,29 +19,47 @@ public:
 
 private:
     void timerCallback() override;
+    void buttonClicked (juce::Button*) override;
     void updateUiFromParameters();
     void updateMsLabel();
     void updateManualBpmFromHost();
+    void updateReverseLookup();
+    void showOptionsMenu();
 
     PassthroughTempoProcessor& processorRef;
+    juce::SharedResourcePointer<BPM2TimeLookAndFeel> lookAndFeel;
 
-    juce::TextButton b128 { "1/128" };
-    juce::TextButton b64 { "1/64" };
-    juce::TextButton b32 { "1/32" };
-    juce::TextButton b16 { "1/16" };
-    juce::TextButton b8  { "1/8" };
-    juce::TextButton b4  { "1/4" };
-    juce::TextButton b2  { "1/2" };
-    juce::TextButton b1  { "1/1" };
+    // Where paint() draws the static captions, set by resized()
+    juce::Rectangle<int> titleArea;
+    juce::Rectangle<int> divisionCaptionArea;
+
+    // One per division, in the same order as the "division" parameter's choices
+    std::array<juce::TextButton, TempoMap::numDivisions> divisionButtons;
     
     juce::Label msLabel;
     juce::Label statusLabel;
     juce::Label bpmLabel;
 
+    BeatPhaseDisplay beatDisplay;
+    juce::TextButton optionsButton { "Options" };
+
     juce::ToggleButton syncToggle { "Sync to Host" };
     juce::Slider manualBpmSlider;
+
+    // Reverse solver: type a time, get the tempo/division combinations that hit it. The
+    // shared index is only picked up the first time something's typed, so opening an
+    // editor doesn't start building it.
+    std::optional<juce::SharedResourcePointer<DivisionIndex>> divisionIndex;
+    juce::Label targetMsLabel;
+    juce::TextEditor targetMsEditor;
+    juce::Label reverseResultsLabel;
+    bool reverseLookupPending = false;      // Waiting for the index; retried from the timer
+
+    juce::ToggleButton grooveToggle { "Groove" };
+    GrooveDisplay grooveDisplay;
     
     std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> syncAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> grooveAttachment;
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> manualBpmAttachment;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PassthroughTempoEditor)
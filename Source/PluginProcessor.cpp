@@ -1,5 +1,6 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
+#include "TempoMapDocumentController.h"
 
 juce::AudioProcessorValueTreeState::ParameterLayout PassthroughTempoProcessor::createParameterLayout()
 {
@@ -17,6 +18,24 @@ juce::AudioProcessorValueTreeState::ParameterLayout PassthroughTempoProcessor::c
         juce::NormalisableRange<float> (20.0f, 300.0f, 0.01f),
         120.0f));
 
+    params.push_back (std::make_unique<juce::AudioParameterBool> (
+        "grooveAnalysis", "Groove Analysis", false));
+
+    // Tempo conditioning is a setup choice rather than something to automate
+    params.push_back (std::make_unique<juce::AudioParameterChoice> (
+        "tempoFilter", "Tempo Filter", juce::StringArray { "None", "Median", "One-euro" }, 1,
+        juce::AudioParameterChoiceAttributes().withAutomatable (false)));
+
+    params.push_back (std::make_unique<juce::AudioParameterFloat> (
+        "tempoDeadband", "Tempo Deadband",
+        juce::NormalisableRange<float> (0.0f, 0.5f, 0.001f),
+        0.005f,
+        juce::AudioParameterFloatAttributes().withAutomatable (false).withLabel ("BPM")));
+
+    params.push_back (std::make_unique<juce::AudioParameterChoice> (
+        "tempoSnap", "Tempo Snap", juce::StringArray { "Off", "0.01 BPM", "0.1 BPM", "1 BPM" }, 0,
+        juce::AudioParameterChoiceAttributes().withAutomatable (false)));
+
     return { params.begin(), params.end() };
 }
 
@@ -27,72 +46,113 @@ PassthroughTempoProcessor::PassthroughTempoProcessor()
                      .withInput  ("Input",  juce::AudioChannelSet::stereo(), true)
  #endif
                      .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
+                     .withOutput ("Clock",  juce::AudioChannelSet::discreteChannels (3), false)
 #endif
                      ),
       apvts (*this, nullptr, "PARAMETERS", createParameterLayout())
 {
-    apvts.addParameterListener ("division", this);
-    apvts.addParameterListener ("syncBpm", this);
-    apvts.addParameterListener ("manualBpm", this);
+    divisionParam  = dynamic_cast<juce::AudioParameterChoice*> (apvts.getParameter ("division"));
+    syncParam      = dynamic_cast<juce::AudioParameterBool*> (apvts.getParameter ("syncBpm"));
+    manualBpmParam = apvts.getRawParameterValue ("manualBpm");
+    grooveParam    = dynamic_cast<juce::AudioParameterBool*> (apvts.getParameter ("grooveAnalysis"));
+
+    tempoFilterParam   = apvts.getRawParameterValue ("tempoFilter");
+    tempoDeadbandParam = apvts.getRawParameterValue ("tempoDeadband");
+    tempoSnapParam     = apvts.getRawParameterValue ("tempoSnap");
+
+    jassert (divisionParam != nullptr && syncParam != nullptr && manualBpmParam != nullptr && grooveParam != nullptr);
+    jassert (tempoFilterParam != nullptr && tempoDeadbandParam != nullptr && tempoSnapParam != nullptr);
 }
 
 PassthroughTempoProcessor::~PassthroughTempoProcessor()
 {
-    apvts.removeParameterListener ("division", this);
-    apvts.removeParameterListener ("syncBpm", this);
-    apvts.removeParameterListener ("manualBpm", this);
+    // Stop the writer threads from touching the capture and log before they're destroyed
+    playheadCapture.stop();
+    tempoLog.stop();
+    tempoExport->release (this);
 }
 
-void PassthroughTempoProcessor::prepareToPlay (double sampleRate, int /*samplesPerBlock*/)
+void PassthroughTempoProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
     bpmCheckInterval = static_cast<int> (sampleRate * 0.5);
-}
 
-void PassthroughTempoProcessor::releaseResources()
-{
+    if (! deterministic)
+    {
+        // Setting BPM2TIME_CAPTURE_DIR captures a playhead trace per prepared session,
+        // for building a library of real host behaviour to replay later
+        auto captureDir = juce::SystemStats::getEnvironmentVariable ("BPM2TIME_CAPTURE_DIR", {});
+        if (captureDir.isNotEmpty() && juce::File::isAbsolutePath (captureDir))
+        {
+            juce::File dir (captureDir);
+            dir.createDirectory();
+            startPlayheadCapture (dir.getNonexistentChildFile ("playhead", ".bptrace", false));
+        }
+
+        // Likewise BPM2TIME_LOG_DIR turns on the tempo diagnostics log from the start. It
+        // can also be switched on and off from the editor's Options menu.
+        if (juce::SystemStats::getEnvironmentVariable ("BPM2TIME_LOG_DIR", {}).isNotEmpty() && ! tempoLog.isActive())
+            startTempoLog (getTempoLogDirectory());
+
+        tempoExport->prepare();
+    }
+    else
+    {
+        // Every replay starts from a freshly constructed processor's state, so replaying
+        // the same blocks on the same processor always gives the same results
+        samplesSinceLastBpmCheck = 0;
+        prevIsPlaying = false;
+        loggedMissingPosition = false;
+        prevPpqPosition = -1.0;
+        prevBpmReported = -1.0;
+        samplesProcessed = 0;
+        tempoConditioner.reset();
+        cachedBpm.store (120.0, std::memory_order_relaxed);
+        haveValidBpm.store (false, std::memory_order_relaxed);
+        lastPpqPosition.store (0.0, std::memory_order_relaxed);
+    }
+
+    if (tempoLog.isActive())
+        logTempoEvent (TempoLogFormat::Event::prepared, 0, nullptr, samplesPerBlock);
+
+    clockOutput.prepare (sampleRate, samplesPerBlock);
+    grooveAnalyser.prepare (sampleRate);
+
+   #if JucePlugin_Enable_ARA
+    prepareToPlayForARA (sampleRate, samplesPerBlock, getMainBusNumOutputChannels(), getProcessingPrecision());
+   #endif
 }
 
-void PassthroughTempoProcessor::parameterChanged (const juce::String& /*paramID*/, float /*newValue*/)
+void PassthroughTempoProcessor::releaseResources()
 {
+   #if JucePlugin_Enable_ARA
+    releaseResourcesForARA();
+   #endif
 }
 
 int PassthroughTempoProcessor::getSelectedDenominator() const
 {
-    if (auto* p = dynamic_cast<juce::AudioParameterChoice*> (apvts.getParameter ("division")))
-    {
-        int idx = p->getIndex();
-        const int map[] = { 128, 64, 32, 16, 8, 4, 2, 1 };
-        if (idx >= 0 && idx <= 7)
-            return map[idx];
-    }
+    int idx = divisionParam->getIndex();
+    const int map[] = { 128, 64, 32, 16, 8, 4, 2, 1 };
+    if (idx >= 0 && idx <= 7)
+        return map[idx];
     return 16;
 }
 
 void PassthroughTempoProcessor::setDivisionIndexNotifyingHost (int choiceIndex)
 {
-    if (auto* p = dynamic_cast<juce::AudioParameterChoice*> (apvts.getParameter ("division")))
-    {
-        int numChoices = p->choices.size();
-        float normalized = 0.0f;
-        if (numChoices > 1)
-            normalized = (float) choiceIndex / (float) (numChoices - 1);
-        p->setValueNotifyingHost (normalized);
-    }
+    int numChoices = divisionParam->choices.size();
+    float normalized = 0.0f;
+    if (numChoices > 1)
+        normalized = (float) choiceIndex / (float) (numChoices - 1);
+    divisionParam->setValueNotifyingHost (normalized);
 }
 
 double PassthroughTempoProcessor::getEffectiveBpm() const
 {
-    bool sync = false;
-    if (auto* pb = dynamic_cast<juce::AudioParameterBool*> (apvts.getParameter ("syncBpm")))
-        sync = pb->get();
-
-    if (sync)
-        return cachedBpm;
-
-    if (auto* pf = apvts.getRawParameterValue ("manualBpm"))
-        return (double) pf->load();
+    if (isSyncEnabled())
+        return getCachedBpm();
 
-    return 120.0;
+    return (double) manualBpmParam->load();
 }
 
 bool PassthroughTempoProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
@@ -104,10 +164,18 @@ bool PassthroughTempoProcessor::isBusesLayoutSupported (const BusesLayout& layou
     const auto& outLayout = layouts.getMainOutputChannelSet();
     const auto& inLayout  = layouts.getMainInputChannelSet();
 
-    if (inLayout == outLayout && ! outLayout.isDisabled())
-        return true;
+    if (inLayout != outLayout || outLayout.isDisabled())
+        return false;
 
-    return false;
+    // The optional clock bus takes up to three channels: pulse, beat ramp, bar reset
+    if (layouts.outputBuses.size() > 1)
+    {
+        const auto& clockLayout = layouts.getChannelSet (false, 1);
+        if (! clockLayout.isDisabled() && clockLayout.size() > 3)
+            return false;
+    }
+
+    return true;
 #endif
 }
 
@@ -146,33 +214,66 @@ void PassthroughTempoProcessor::processBlock (juce::AudioBuffer<float>& buffer,
             std::memmove (out, in, (size_t) numSamples * sizeof (float));
     }
 
-    // Only check BPM when sync is enabled and transport is playing
-    bool shouldCheckBpm = false;
-    bool syncEnabled = false;
-    
-    if (auto* pb = dynamic_cast<juce::AudioParameterBool*> (apvts.getParameter ("syncBpm")))
-        syncEnabled = pb->get();
-    
-    if (syncEnabled)
+    juce::Optional<juce::AudioPlayHead::PositionInfo> position;
+    if (auto* ph = getPlayHead())
+        position = ph->getPosition();
+
+    if (playheadCapture.isActive())
+        playheadCapture.push (PlayheadTrace::encode (position, numSamples));
+
+    if (position.hasValue())
     {
-        if (auto* ph = getPlayHead())
-        {
-            if (auto pos = ph->getPosition())
-            {
-                if (pos->getIsPlaying())
-                    shouldCheckBpm = true;
-            }
-        }
+        if (auto ppq = position->getPpqPosition())
+            lastPpqPosition.store (*ppq, std::memory_order_relaxed);
+
+        if (! deterministic)
+            publishTempoSnapshot (*position);
+
+        publishBeatStamp (*position);
+    }
+
+    if (grooveParam->get() && position.hasValue())
+        grooveAnalyser.process (buffer, getMainBusNumInputChannels(), *position, getSelectedDenominator());
+
+    if (auto* clockBus = getBus (false, 1); clockBus != nullptr && clockBus->isEnabled())
+    {
+        auto clockBuffer = getBusBuffer (buffer, false, 1);
+        clockOutput.process (clockBuffer, position, getEffectiveBpm(), getSelectedDenominator());
+    }
+
+    // Only check BPM when sync is enabled and transport is playing, or when the editor
+    // has asked for a reading
+    bool shouldCheckBpm = isSyncEnabled() && position.hasValue() && position->getIsPlaying();
+
+    // Taking the request with exchange() means one made while this block runs is kept for
+    // the next. The plain load first keeps the usual no-request case to a read.
+    bool forcedCheck = isSyncEnabled() && position.hasValue()
+                    && forceBpmCheckRequested.load (std::memory_order_relaxed)
+                    && forceBpmCheckRequested.exchange (false, std::memory_order_relaxed);
+
+    if (tempoLog.isActive())
+    {
+        const bool positionMissing = isSyncEnabled() && ! position.hasValue();
+
+        if (positionMissing && ! loggedMissingPosition)
+            logTempoEvent (TempoLogFormat::Event::missingPosition, TempoLogFormat::syncEnabled, nullptr, numSamples);
+
+        loggedMissingPosition = positionMissing;
     }
     
-    if (shouldCheckBpm)
+    if (shouldCheckBpm || forcedCheck)
     {
+        updateTempoConditioner (*position, numSamples);
+
+        if (shouldCheckBpm)
+            pushTempoSample (*position);
+
         samplesSinceLastBpmCheck += numSamples;
         
-        if (samplesSinceLastBpmCheck >= bpmCheckInterval)
+        if (forcedCheck || samplesSinceLastBpmCheck >= bpmCheckInterval)
         {
             samplesSinceLastBpmCheck = 0;
-            checkBpmFromHost();
+            checkBpmFromHost (*position, numSamples, forcedCheck);
         }
     }
     else
@@ -180,64 +281,298 @@ void PassthroughTempoProcessor::processBlock (juce::AudioBuffer<float>& buffer,
         // Reset counter when stopped or sync disabled so we check immediately when conditions are met
         samplesSinceLastBpmCheck = 0;
     }
+
+    samplesProcessed += (uint64_t) numSamples;
 }
 
-void PassthroughTempoProcessor::checkBpmFromHost()
+void PassthroughTempoProcessor::checkBpmFromHost (const juce::AudioPlayHead::PositionInfo& pos, int numSamples, bool forced)
 {
-    if (auto* ph = getPlayHead())
+    bool transportChanged = (pos.getIsPlaying() != prevIsPlaying);
+    
+    bool ppqMoved = false;
+    if (auto ppq = pos.getPpqPosition())
     {
-        if (auto pos = ph->getPosition())
-        {
-            bool transportChanged = (pos->getIsPlaying() != prevIsPlaying);
-            
-            bool ppqMoved = false;
-            if (auto ppq = pos->getPpqPosition())
-            {
-                if (prevPpqPosition >= 0.0)
-                    ppqMoved = (std::abs (*ppq - prevPpqPosition) > 1.0e-5);
-                else
-                    ppqMoved = true;
-                prevPpqPosition = *ppq;
-            }
-            
-            bool bpmChanged = false;
-            if (auto bpm = pos->getBpm())
-            {
-                if (std::abs (*bpm - prevBpmReported) > 1.0e-6)
-                    bpmChanged = true;
-                    
-                if (transportChanged || ppqMoved || bpmChanged)
-                {
-                    cachedBpm = *bpm;
-                    haveValidBpm = true;
-                    prevBpmReported = *bpm;
-                }
-            }
+        if (prevPpqPosition >= 0.0)
+            ppqMoved = (std::abs (*ppq - prevPpqPosition) > 1.0e-5);
+        else
+            ppqMoved = true;
+        prevPpqPosition = *ppq;
+    }
+    
+    // Use the conditioned tempo so host jitter doesn't register as a change
+    bool bpmChanged = false;
+    bool updated = false;
+
+    if (tempoConditioner.hasValue())
+    {
+        const double bpm = tempoConditioner.getBpm();
+        bpmChanged = std::abs (bpm - prevBpmReported) > 1.0e-6;
             
-            prevIsPlaying = pos->getIsPlaying();
+        if (transportChanged || ppqMoved || bpmChanged || forced)
+        {
+            cachedBpm.store (bpm, std::memory_order_relaxed);
+            haveValidBpm.store (true, std::memory_order_relaxed);
+            prevBpmReported = bpm;
+            updated = true;
         }
     }
+    
+    prevIsPlaying = pos.getIsPlaying();
+
+    if (tempoLog.isActive())
+    {
+        uint16_t flags = TempoLogFormat::syncEnabled;
+        if (transportChanged)         flags |= TempoLogFormat::transportChanged;
+        if (ppqMoved)                 flags |= TempoLogFormat::ppqMoved;
+        if (bpmChanged)               flags |= TempoLogFormat::bpmChanged;
+        if (updated)                  flags |= TempoLogFormat::cachedBpmUpdated;
+        if (forced)                   flags |= TempoLogFormat::forcedCheck;
+
+        logTempoEvent (TempoLogFormat::Event::bpmCheck, flags, &pos, numSamples);
+    }
 }
 
-void PassthroughTempoProcessor::forceReadBpmFromHost()
+bool PassthroughTempoProcessor::startTempoLog (const juce::File& directory)
 {
-    if (auto* ph = getPlayHead())
+    return tempoLog.start (directory, getSampleRate());
+}
+
+juce::File PassthroughTempoProcessor::getTempoLogDirectory()
+{
+    auto logDir = juce::SystemStats::getEnvironmentVariable ("BPM2TIME_LOG_DIR", {});
+
+    if (logDir.isNotEmpty() && juce::File::isAbsolutePath (logDir))
+        return juce::File (logDir);
+
+   #if JUCE_MAC
+    return juce::File::getSpecialLocation (juce::File::userHomeDirectory).getChildFile ("Library/Logs/BPM2Time");
+   #else
+    return juce::File::getSpecialLocation (juce::File::userApplicationDataDirectory).getChildFile ("BPM2Time/Logs");
+   #endif
+}
+
+void PassthroughTempoProcessor::logTempoEvent (TempoLogFormat::Event event, uint16_t flags,
+                                               const juce::AudioPlayHead::PositionInfo* pos, int blockSize) noexcept
+{
+    TempoLogFormat::Record r;
+    r.sampleCount = samplesProcessed;
+    r.wallClockMs = juce::Time::getMillisecondCounterHiRes();
+    r.event = (uint16_t) event;
+    r.blockSize = (uint32_t) juce::jmax (0, blockSize);
+    r.conditionedBpm = tempoConditioner.hasValue() ? tempoConditioner.getBpm() : 0.0;
+    r.cachedBpm = getCachedBpm();
+
+    if (pos != nullptr)
     {
-        if (auto pos = ph->getPosition())
-        {
-            if (auto bpm = pos->getBpm())
-            {
-                cachedBpm = *bpm;
-                haveValidBpm = true;
-                prevBpmReported = *bpm;
-            }
-            
-            if (auto ppq = pos->getPpqPosition())
-                prevPpqPosition = *ppq;
-            
-            prevIsPlaying = pos->getIsPlaying();
-        }
+        if (pos->getIsPlaying())
+            flags |= TempoLogFormat::isPlaying;
+
+        if (auto bpm = pos->getBpm())
+            r.hostBpm = *bpm;
+        else
+            flags |= TempoLogFormat::hostBpmMissing;
+
+        if (auto ppq = pos->getPpqPosition())
+            r.ppqPosition = *ppq;
+        else
+            flags |= TempoLogFormat::hostPpqMissing;
+    }
+
+    r.flags = flags;
+    tempoLog.push (r);
+}
+
+bool PassthroughTempoProcessor::startPlayheadCapture (const juce::File& file)
+{
+    return playheadCapture.start (file, getSampleRate(), getBlockSize(),
+                                  juce::jmax (getTotalNumInputChannels(), getTotalNumOutputChannels()));
+}
+
+void PassthroughTempoProcessor::applyTempoConditionerParameters() noexcept
+{
+    const auto snapIndex = juce::jlimit (0, (int) tempoSnapResolutions.size() - 1, juce::roundToInt (tempoSnapParam->load()));
+
+    auto settings = tempoConditioner.getSettings();
+    const auto filterMode = (TempoConditioner::FilterMode) juce::jlimit (0, 2, juce::roundToInt (tempoFilterParam->load()));
+    const auto deadbandBpm = (double) tempoDeadbandParam->load();
+    const auto snapResolutionBpm = tempoSnapResolutions[(size_t) snapIndex];
+
+    if (settings.filterMode == filterMode && settings.deadbandBpm == deadbandBpm && settings.snapResolutionBpm == snapResolutionBpm)
+        return;
+
+    settings.filterMode = filterMode;
+    settings.deadbandBpm = deadbandBpm;
+    settings.snapResolutionBpm = snapResolutionBpm;
+    tempoConditioner.setSettings (settings);
+}
+
+void PassthroughTempoProcessor::updateTempoConditioner (const juce::AudioPlayHead::PositionInfo& pos, int numSamples)
+{
+    applyTempoConditionerParameters();
+
+    if (auto bpm = pos.getBpm())
+    {
+        const double sampleRate = getSampleRate();
+        const bool changed = tempoConditioner.process (*bpm, sampleRate > 0.0 ? numSamples / sampleRate : 0.0);
+
+        if (changed && tempoLog.isActive())
+            logTempoEvent (TempoLogFormat::Event::conditionedChange, TempoLogFormat::syncEnabled, &pos, numSamples);
+    }
+}
+
+void PassthroughTempoProcessor::publishTempoSnapshot (const juce::AudioPlayHead::PositionInfo& pos)
+{
+    if (! tempoExport->tryClaim (this))
+        return;
+
+    TempoExport::Snapshot snapshot;
+    snapshot.bpm = getEffectiveBpm();
+    snapshot.hostProvidedBpm = hostProvidedBpm() ? 1 : 0;
+    snapshot.isPlaying = pos.getIsPlaying() ? 1 : 0;
+    snapshot.selectedDenominator = getSelectedDenominator();
+
+    if (snapshot.bpm > 0.0)
+        snapshot.divisionMs = (60000.0 / snapshot.bpm) * (4.0 / (double) snapshot.selectedDenominator);
+
+    if (auto ppq = pos.getPpqPosition())
+    {
+        snapshot.ppqPosition = *ppq;
+        snapshot.beatPhase = *ppq - std::floor (*ppq);
+    }
+
+    if (auto sig = pos.getTimeSignature())
+    {
+        snapshot.timeSigNumerator = sig->numerator;
+        snapshot.timeSigDenominator = sig->denominator;
+    }
+
+    tempoExport->push (snapshot);
+}
+
+void PassthroughTempoProcessor::pushTempoSample (const juce::AudioPlayHead::PositionInfo& pos)
+{
+    // Record the conditioned tempo rather than the host's raw value, so that jitter in
+    // the host's reporting doesn't end up as segments in the tempo map
+    auto ppq = pos.getPpqPosition();
+
+    if (! ppq.hasValue() || ! tempoConditioner.hasValue())
+        return;
+
+    const auto scope = tempoSampleFifo.write (1);
+
+    if (scope.blockSize1 > 0)
+        tempoSamples[(size_t) scope.startIndex1] = { *ppq, tempoConditioner.getBpm() };
+}
+
+void PassthroughTempoProcessor::publishBeatStamp (const juce::AudioPlayHead::PositionInfo& pos)
+{
+    BeatStamp stamp;
+
+    if (deterministic)
+    {
+        // Time from the sample position. A recorded host time is on another machine's clock.
+        stamp.publishedNs = (int64_t) ((double) samplesProcessed / getSampleRate() * 1.0e9);
+    }
+    else
+    {
+        stamp.publishedNs = BeatClock::nowNs();
+        stamp.hostTimeNs = (int64_t) pos.getHostTimeNs().orFallback (0);
     }
+
+    stamp.ppqPosition = pos.getPpqPosition().orFallback (0.0);
+    stamp.ppqOfLastBarStart = pos.getPpqPositionOfLastBarStart().orFallback (0.0);
+    stamp.bpm = pos.getBpm().orFallback (getEffectiveBpm());
+    stamp.isPlaying = pos.getIsPlaying();
+
+    if (auto sig = pos.getTimeSignature())
+    {
+        stamp.timeSigNumerator = sig->numerator;
+        stamp.timeSigDenominator = sig->denominator;
+    }
+
+    beatClock.publish (stamp);
+}
+
+void PassthroughTempoProcessor::processQueuedAnalysis()
+{
+    const auto scope = tempoSampleFifo.read (tempoSampleFifo.getNumReady());
+
+    for (int i = 0; i < scope.blockSize1; ++i)
+        tempoCurveRecorder.addSample (tempoSamples[(size_t) (scope.startIndex1 + i)]);
+
+    for (int i = 0; i < scope.blockSize2; ++i)
+        tempoCurveRecorder.addSample (tempoSamples[(size_t) (scope.startIndex2 + i)]);
+
+    if (scope.blockSize2 > 0)
+        latestTempoSample = tempoSamples[(size_t) (scope.startIndex2 + scope.blockSize2 - 1)];
+    else if (scope.blockSize1 > 0)
+        latestTempoSample = tempoSamples[(size_t) (scope.startIndex1 + scope.blockSize1 - 1)];
+
+    if (tempoCurveRecorder.hasChanged())
+        tempoCurveRecorder.fillTempoMap (tempoMap);
+
+    grooveAnalyser.popHits ([this] (const GrooveHit& hit) { grooveHistogram.add (hit); });
+}
+
+void PassthroughTempoProcessor::discardQueuedGrooveHits()
+{
+    grooveAnalyser.popHits ([] (const GrooveHit&) {});
+}
+
+double PassthroughTempoProcessor::getCurrentDivisionMs() const
+{
+    const double effectiveBpm = getEffectiveBpm();
+    const int denom = getSelectedDenominator();
+
+    if (effectiveBpm <= 0.0)
+        return 0.0;
+
+    const double constantMs = (60000.0 / effectiveBpm) * (4.0 / static_cast<double> (denom));
+
+    if (! isSyncEnabled() || ! hostProvidedBpm() || latestTempoSample.bpm <= 0.0)
+        return constantMs;
+
+    // Check the map against a tempo taken at the same position rather than cachedBpm,
+    // which is only refreshed every half second and so always trails a ramp in progress.
+    // The conditioned tempo itself lags a steep ramp by a block or two, so a map from the
+    // host is allowed to differ by a fraction of a percent.
+    const auto& map = getTempoMap();
+    const auto sample = latestTempoSample;
+    const auto tolerance = juce::jmax (TempoCurveRecorder::holdToleranceBpm, sample.bpm * 0.005);
+
+    if (map.isEmpty() || std::abs (map.getBpmAt (sample.ppq, sample.bpm) - sample.bpm) > tolerance)
+        return constantMs;
+
+    return map.getDivisionDurationMs (sample.ppq, denom, sample.bpm);
+}
+
+const TempoMap& PassthroughTempoProcessor::getTempoMap() const
+{
+   #if JucePlugin_Enable_ARA
+    auto fromARA = [] (auto* role) -> TempoMapDocumentController*
+    {
+        if (role == nullptr)
+            return nullptr;
+
+        return juce::ARADocumentControllerSpecialisation::getSpecialisedDocumentController<TempoMapDocumentController> (
+            role->getDocumentController());
+    };
+
+    if (auto* dc = fromARA (getPlaybackRenderer()))
+        return dc->getTempoMap();
+
+    if (auto* dc = fromARA (getEditorView()))
+        return dc->getTempoMap();
+   #endif
+
+    return tempoMap;
+}
+
+void PassthroughTempoProcessor::forceReadBpmFromHost()
+{
+    // The playhead can only be asked for its position from processBlock, so the audio
+    // thread does the reading
+    forceBpmCheckRequested.store (true, std::memory_order_relaxed);
 }
 
 juce::AudioProcessorEditor* PassthroughTempoProcessor::createEditor()
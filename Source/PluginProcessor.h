@@ -1,8 +1,19 @@
 #pragma once
 #include <JuceHeader.h>
+#include "BeatClock.h"
+#include "ClockOutputGenerator.h"
+#include "GrooveAnalyser.h"
+#include "PlayheadTrace.h"
+#include "TempoExportWriter.h"
+#include "TempoLog.h"
+#include "TempoCurveRecorder.h"
+#include "TempoConditioner.h"
+#include "TempoMap.h"
 
-class PassthroughTempoProcessor : public juce::AudioProcessor,
-                                  private juce::AudioProcessorValueTreeState::Listener
+class PassthroughTempoProcessor : public juce::AudioProcessor
+                                 #if JucePlugin_Enable_ARA
+                                , public juce::AudioProcessorARAExtension
+                                 #endif
 {
 public:
     PassthroughTempoProcessor();
@@ -37,24 +48,133 @@ public:
     // Public interface for editor
     double getEffectiveBpm() const;
     int getSelectedDenominator() const;
-    bool hostProvidedBpm() const { return haveValidBpm; }
+    bool isSyncEnabled() const { return syncParam->get(); }
+    bool hostProvidedBpm() const noexcept { return haveValidBpm.load (std::memory_order_relaxed); }
+    double getCachedBpm() const noexcept { return cachedBpm.load (std::memory_order_relaxed); }
     void setDivisionIndexNotifyingHost (int choiceIndex);
-    void forceReadBpmFromHost();  // Force immediate BPM read from host
+
+    // Asks the audio thread to read the host tempo on its next block, even while stopped.
+    // The value goes through the tempo conditioner like any other.
+    void forceReadBpmFromHost();
+
+    // Tempo conditioning settings live in the (non-automatable) "tempoFilter",
+    // "tempoDeadband" and "tempoSnap" parameters, so they're saved with the session
+    static constexpr std::array<double, 4> tempoSnapResolutions { 0.0, 0.01, 0.1, 1.0 };
+
+    // Logs the playhead and block size seen by every processBlock call to a trace file
+    bool startPlayheadCapture (const juce::File&);
+    void stopPlayheadCapture() { playheadCapture.stop(); }
+    bool isCapturingPlayhead() const noexcept { return playheadCapture.isActive(); }
+
+    // For replaying traces: ignores BPM2TIME_CAPTURE_DIR and BPM2TIME_LOG_DIR, doesn't
+    // publish to the tempo export, and times beat stamps from the sample position rather
+    // than the clock, so the same blocks always give the same results. Set before prepareToPlay().
+    void setDeterministic (bool shouldBeDeterministic) noexcept { deterministic = shouldBeDeterministic; }
+
+    // Structured log of tempo-handling decisions, decoded by Tools/TempoLogDecoder.cpp
+    bool startTempoLog (const juce::File& directory);
+    void stopTempoLog() { tempoLog.stop(); }
+    bool isTempoLogging() const noexcept { return tempoLog.isActive(); }
+
+    // Where the editor's log toggle writes to: BPM2TIME_LOG_DIR if it's set, otherwise
+    // ~/Library/Logs/BPM2Time on macOS or BPM2Time/Logs in the user's application data
+    static juce::File getTempoLogDirectory();
+
+    // Whole-song tempo map: from ARA when the host provides one, otherwise recorded from
+    // the tempo seen during playback. Message thread only.
+    const TempoMap& getTempoMap() const;
+    double getLastPpqPosition() const noexcept { return lastPpqPosition.load (std::memory_order_relaxed); }
+
+    // Length of the selected division starting from the latest position. While synced it's
+    // integrated along the tempo map, as long as the map agrees with the tempo recorded at
+    // that position. Message thread only.
+    double getCurrentDivisionMs() const;
+    const BeatClock& getBeatClock() const noexcept { return beatClock; }
+    const GrooveHistogram& getGrooveHistogram() const noexcept { return grooveHistogram; }
+
+    // Message thread: moves the tempo samples and groove hits queued by the audio thread
+    // into the tempo map and groove histogram. The editor calls this from its timer, so
+    // instances without an open editor don't run a timer of their own.
+    void processQueuedAnalysis();
+
+    // Message thread: drops the groove hits queued while no editor was draining them, which
+    // by the time one opens could be from any time since the last one closed. The editor
+    // calls this when it's created, so the histogram only picks up hits from then on.
+    void discardQueuedGrooveHits();
 
     juce::AudioProcessorValueTreeState apvts;
-    double cachedBpm = 120.0;  // Made public so editor can read it
 
 private:
-    void parameterChanged (const juce::String& paramID, float newValue) override;
     static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
-    void checkBpmFromHost();
+    void checkBpmFromHost (const juce::AudioPlayHead::PositionInfo&, int numSamples, bool forced);
+    void logTempoEvent (TempoLogFormat::Event, uint16_t flags, const juce::AudioPlayHead::PositionInfo*, int blockSize) noexcept;
+    void applyTempoConditionerParameters() noexcept;
+    void updateTempoConditioner (const juce::AudioPlayHead::PositionInfo&, int numSamples);
+    void publishTempoSnapshot (const juce::AudioPlayHead::PositionInfo&);
+    void pushTempoSample (const juce::AudioPlayHead::PositionInfo&);
+    void publishBeatStamp (const juce::AudioPlayHead::PositionInfo&);
+
+    // Looked up once in the constructor so the audio thread never has to search the APVTS
+    juce::AudioParameterChoice* divisionParam = nullptr;
+    juce::AudioParameterBool* syncParam = nullptr;
+    std::atomic<float>* manualBpmParam = nullptr;
+    juce::AudioParameterBool* grooveParam = nullptr;
+    std::atomic<float>* tempoFilterParam = nullptr;
+    std::atomic<float>* tempoDeadbandParam = nullptr;
+    std::atomic<float>* tempoSnapParam = nullptr;
 
-    bool haveValidBpm = false;
+    // Members are grouped by which threads touch them, so that what the audio thread writes
+    // on every block doesn't share a cache line with anything another thread reads or
+    // writes. Lock-free queues are the exception: both threads write their indices by
+    // design, so each queue gets a line of its own, away from the per-block state.
+    // ParallelInstanceBenchmark runs instances on every core with a stand-in message thread
+    // reading them the way an editor does, which is where false sharing would show up.
+    // 128 bytes covers Apple silicon's line size and x86's adjacent-line prefetch.
+    static constexpr size_t cacheLineSize = 128;
+
+    // Audio thread only. prepareToPlay() and setDeterministic() write some of these, but
+    // never while blocks are being processed.
+    alignas (cacheLineSize) int samplesSinceLastBpmCheck = 0;
+    int bpmCheckInterval = 24000;
     bool prevIsPlaying = false;
+    bool loggedMissingPosition = false;
+    bool deterministic = false;
     double prevPpqPosition = -1.0;
     double prevBpmReported = -1.0;
-    int samplesSinceLastBpmCheck = 0;
-    int bpmCheckInterval = 24000;
+    uint64_t samplesProcessed = 0;
+    TempoConditioner tempoConditioner;
+    ClockOutputGenerator clockOutput;
+    juce::SharedResourcePointer<TempoExportWriter> tempoExport;   // The pointer's only read after construction
+
+    // Written by the audio thread, read by the editor's timer
+    alignas (cacheLineSize) std::atomic<double> cachedBpm { 120.0 };
+    std::atomic<bool> haveValidBpm { false };
+    std::atomic<double> lastPpqPosition { 0.0 };
+
+    // Written by the audio thread every block, read by the beat display on every frame
+    alignas (cacheLineSize) BeatClock beatClock;
+
+    // Set by the message thread, read and cleared by the audio thread
+    alignas (cacheLineSize) std::atomic<bool> forceBpmCheckRequested { false };
+
+    // Written by the audio thread every block while groove analysis is on. The hit queue
+    // inside it, whose read index the editor's timer advances, is aligned separately.
+    alignas (cacheLineSize) GrooveAnalyser grooveAnalyser;
+
+    // Per-block tempo samples, handed from the audio thread to the recorder on the message thread
+    static constexpr int tempoSampleFifoSize = 1024;
+    alignas (cacheLineSize) juce::AbstractFifo tempoSampleFifo { tempoSampleFifoSize };
+    alignas (cacheLineSize) std::array<TempoCurveRecorder::Sample, tempoSampleFifoSize> tempoSamples;
+
+    // Written by the audio thread only while capturing or logging, through their own queues
+    alignas (cacheLineSize) PlayheadTrace::Capture playheadCapture;
+    TempoLog tempoLog;
+
+    // The message thread's alone
+    alignas (cacheLineSize) GrooveHistogram grooveHistogram;
+    TempoMap tempoMap;
+    TempoCurveRecorder tempoCurveRecorder;
+    TempoCurveRecorder::Sample latestTempoSample;   // The last one drained, a position and its tempo
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PassthroughTempoProcessor)
 };
@@ -0,0 +1,88 @@
+#include "TempoConditioner.h"
+
+namespace
+{
+    double smoothingFactor (double cutoffHz, double dt)
+    {
+        const auto tau = 1.0 / (juce::MathConstants<double>::twoPi * cutoffHz);
+        return 1.0 / (1.0 + tau / dt);
+    }
+}
+
+void TempoConditioner::setSettings (const Settings& newSettings) noexcept
+{
+    settings = newSettings;
+    reset();
+}
+
+void TempoConditioner::reset() noexcept
+{
+    medianWriteIndex = 0;
+    medianCount = 0;
+    euroDerivative = 0.0;
+    primed = false;
+}
+
+bool TempoConditioner::process (double rawBpm, double secondsSinceLastValue) noexcept
+{
+    if (rawBpm <= 0.0)
+        return false;
+
+    if (! primed)
+    {
+        medianHistory.fill (rawBpm);
+        medianCount = medianLength;
+        euroValue = rawBpm;
+        euroDerivative = 0.0;
+        heldBpm = snap (rawBpm);
+        primed = true;
+        return true;
+    }
+
+    double filtered = rawBpm;
+
+    switch (settings.filterMode)
+    {
+        case FilterMode::median:  filtered = filterMedian (rawBpm); break;
+        case FilterMode::oneEuro: filtered = filterOneEuro (rawBpm, juce::jmax (secondsSinceLastValue, 1.0e-6)); break;
+        case FilterMode::none:    break;
+    }
+
+    filtered = snap (filtered);
+
+    // Hysteresis: the held value only moves once the input leaves the deadband around it
+    if (std::abs (filtered - heldBpm) <= settings.deadbandBpm)
+        return false;
+
+    heldBpm = filtered;
+    return true;
+}
+
+double TempoConditioner::filterMedian (double value) noexcept
+{
+    medianHistory[(size_t) medianWriteIndex] = value;
+    medianWriteIndex = (medianWriteIndex + 1) % medianLength;
+    medianCount = juce::jmin (medianCount + 1, medianLength);
+
+    std::array<double, medianLength> sorted = medianHistory;
+    std::sort (sorted.begin(), sorted.begin() + medianCount);
+    return sorted[(size_t) (medianCount / 2)];
+}
+
+double TempoConditioner::filterOneEuro (double value, double dt) noexcept
+{
+    const auto derivative = (value - euroValue) / dt;
+    euroDerivative += smoothingFactor (settings.derivativeCutoffHz, dt) * (derivative - euroDerivative);
+
+    const auto cutoff = settings.minCutoffHz + settings.beta * std::abs (euroDerivative);
+    euroValue += smoothingFactor (cutoff, dt) * (value - euroValue);
+    return euroValue;
+}
+
+double TempoConditioner::snap (double value) const noexcept
+{
+    if (settings.snapResolutionBpm <= 0.0)
+        return value;
+
+    return std::round (value / settings.snapResolutionBpm) * settings.snapResolutionBpm;
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <JuceHeader.h>
+
+/** Cleans up the raw tempo reported by the host before anything downstream sees it.
+
+    Some hosts wobble by a few millionths of a BPM from block to block, or drift around
+    while chasing an external clock. Each raw value goes through an optional filter
+    (running median or one-euro), is snapped to the host's tempo resolution, and only
+    replaces the held output once it moves further than the deadband from it. Every step
+    is constant time, so this can run on every block.
+*/
+class TempoConditioner
+{
+public:
+    enum class FilterMode
+    {
+        none,
+        median,
+        oneEuro
+    };
+
+    struct Settings
+    {
+        double deadbandBpm = 0.005;
+        FilterMode filterMode = FilterMode::median;
+        double snapResolutionBpm = 0.0;     // 0 disables snapping
+
+        // One-euro filter tuning
+        double minCutoffHz = 1.0;
+        double beta = 0.5;
+        double derivativeCutoffHz = 1.0;
+    };
+
+    void setSettings (const Settings& newSettings) noexcept;
+    const Settings& getSettings() const noexcept { return settings; }
+
+    void reset() noexcept;
+
+    /** Feeds one raw host tempo. Returns true when the conditioned tempo changed. */
+    bool process (double rawBpm, double secondsSinceLastValue) noexcept;
+
+    double getBpm() const noexcept { return heldBpm; }
+    bool hasValue() const noexcept { return primed; }
+
+private:
+    static constexpr int medianLength = 5;
+
+    double filterMedian (double value) noexcept;
+    double filterOneEuro (double value, double dt) noexcept;
+    double snap (double value) const noexcept;
+
+    Settings settings;
+
+    std::array<double, medianLength> medianHistory {};
+    int medianWriteIndex = 0;
+    int medianCount = 0;
+
+    double euroValue = 0.0;
+    double euroDerivative = 0.0;
+
+    double heldBpm = 0.0;
+    bool primed = false;
+};
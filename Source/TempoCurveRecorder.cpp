@@ -0,0 +1,174 @@
+#include "TempoCurveRecorder.h"
+
+namespace
+{
+    constexpr double bpmTolerance = 1.0e-4;
+    constexpr double slopeTolerance = 0.05;     // Relative change in BPM-per-quarter still counted as one ramp
+    constexpr double maxRampGapQuarters = 1.0;  // Samples further apart than this can't be joined by a ramp
+}
+
+void TempoCurveRecorder::reset()
+{
+    segments.clear();
+    haveLastSample = false;
+    changed = true;
+}
+
+void TempoCurveRecorder::startSegment (TempoMap::Shape shape, Sample from, double endBpm)
+{
+    TempoMap::Segment s;
+    s.startPpq = from.ppq;
+    s.bpm = from.bpm;
+    s.endBpm = endBpm;
+    s.shape = shape;
+    segments.push_back (s);
+
+    if (segments.size() > maxSegments)
+        mergeClosestSegments();
+}
+
+void TempoCurveRecorder::mergeClosestSegments()
+{
+    // Merging only ever removes the later segment of a pair, so the open segment at the
+    // end (which later samples extend) is never among the candidates
+    size_t best = 0;
+    double bestDifference = std::numeric_limits<double>::max();
+
+    for (size_t i = 0; i + 2 < segments.size(); ++i)
+    {
+        const auto& a = segments[i];
+        const auto& b = segments[i + 1];
+
+        if (a.shape == TempoMap::Shape::linearRamp || b.shape == TempoMap::Shape::linearRamp)
+            continue;
+
+        const auto difference = std::abs (b.bpm - a.bpm);
+
+        if (difference < bestDifference)
+        {
+            bestDifference = difference;
+            best = i;
+        }
+    }
+
+    // Nothing but ramps: give up the oldest detail instead
+    if (bestDifference == std::numeric_limits<double>::max())
+    {
+        segments[1].startPpq = segments[0].startPpq;
+        segments.erase (segments.begin());
+        return;
+    }
+
+    segments.erase (segments.begin() + (std::ptrdiff_t) best + 1);
+}
+
+void TempoCurveRecorder::addSample (Sample sample)
+{
+    if (sample.bpm <= 0.0)
+        return;
+
+    if (! haveLastSample || segments.empty())
+    {
+        segments.clear();
+        startSegment (TempoMap::Shape::constant, sample, sample.bpm);
+        lastSample = sample;
+        haveLastSample = true;
+        changed = true;
+        return;
+    }
+
+    if (sample.ppq <= lastSample.ppq)
+    {
+        // Looped or relocated backwards. Keep what's recorded unless the host now disagrees.
+        auto it = std::upper_bound (segments.begin(), segments.end(), sample.ppq,
+                                    [] (double p, const TempoMap::Segment& s) { return p < s.startPpq; });
+
+        if (it != segments.begin())
+        {
+            auto& s = *std::prev (it);
+            const auto nextStart = it != segments.end() ? it->startPpq : lastSample.ppq;
+            const auto recordedBpm = s.shape == TempoMap::Shape::linearRamp && nextStart > s.startPpq
+                                       ? s.bpm + (s.endBpm - s.bpm) * (sample.ppq - s.startPpq) / (nextStart - s.startPpq)
+                                       : s.bpm;
+
+            if (std::abs (recordedBpm - sample.bpm) <= holdToleranceBpm)
+                return;
+
+            if (s.shape == TempoMap::Shape::linearRamp)
+                s.endBpm = recordedBpm;
+        }
+
+        // Re-record from here onwards
+        segments.erase (it, segments.end());
+        startSegment (TempoMap::Shape::step, sample, sample.bpm);
+        lastSample = sample;
+        changed = true;
+        return;
+    }
+
+    auto& current = segments.back();
+    const auto deltaPpq = sample.ppq - lastSample.ppq;
+    const auto deltaBpm = sample.bpm - lastSample.bpm;
+    const bool inRamp = current.shape == TempoMap::Shape::linearRamp;
+
+    const auto slope = deltaBpm / deltaPpq;
+    const auto currentSlope = inRamp && lastSample.ppq > current.startPpq
+                                ? (current.endBpm - current.bpm) / (lastSample.ppq - current.startPpq)
+                                : 0.0;
+
+    if (! inRamp && std::abs (sample.bpm - current.bpm) <= holdToleranceBpm)
+    {
+        // Still the held tempo, give or take some wobble
+    }
+    else if (inRamp && deltaPpq <= maxRampGapQuarters && std::abs (deltaBpm) > bpmTolerance
+             && std::abs (slope - currentSlope) <= std::abs (currentSlope) * slopeTolerance)
+    {
+        current.endBpm = sample.bpm;
+        changed = true;
+    }
+    else if (inRamp && std::abs (deltaBpm) <= holdToleranceBpm)
+    {
+        // The ramp finished at the previous sample; hold from there
+        current.endBpm = lastSample.bpm;
+        startSegment (TempoMap::Shape::constant, lastSample, lastSample.bpm);
+        changed = true;
+    }
+    else if (deltaPpq <= maxRampGapQuarters)
+    {
+        if (inRamp)
+            current.endBpm = lastSample.bpm;
+
+        if (std::abs (current.startPpq - lastSample.ppq) < 1.0e-9)
+            segments.pop_back();
+
+        startSegment (TempoMap::Shape::linearRamp, lastSample, sample.bpm);
+        changed = true;
+    }
+    else
+    {
+        if (inRamp)
+            current.endBpm = lastSample.bpm;
+
+        startSegment (TempoMap::Shape::step, sample, sample.bpm);
+        changed = true;
+    }
+
+    lastSample = sample;
+}
+
+void TempoCurveRecorder::fillTempoMap (TempoMap& map)
+{
+    auto copy = segments;
+
+    // An open ramp ends at the last sample we saw; hold that tempo afterwards
+    if (! copy.empty() && copy.back().shape == TempoMap::Shape::linearRamp && haveLastSample)
+    {
+        TempoMap::Segment tail;
+        tail.startPpq = lastSample.ppq;
+        tail.bpm = tail.endBpm = lastSample.bpm;
+        copy.push_back (tail);
+    }
+
+    map.setSegments (std::move (copy));
+    changed = false;
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <JuceHeader.h>
+#include "TempoMap.h"
+
+/** Builds a TempoMap from the (PPQ, BPM) pairs the processor sees at the start of each block.
+
+    Samples are classified as they arrive: a tempo that holds extends the current segment,
+    a tempo that keeps moving at a steady rate becomes a linear ramp, and anything else is
+    treated as a step. Wobble smaller than holdToleranceBpm around a held tempo doesn't
+    start a new segment. If the transport jumps back into territory that's already been
+    recorded, samples there are only used when they disagree with what was recorded.
+
+    The curve never holds more than maxSegments segments: past that, the two neighbouring
+    held tempos that are closest together are merged.
+
+    Not thread-safe; the processor feeds it on the message thread.
+*/
+class TempoCurveRecorder
+{
+public:
+    static constexpr double holdToleranceBpm = 0.05;
+    static constexpr size_t maxSegments = 2048;
+
+    struct Sample
+    {
+        double ppq = 0.0;
+        double bpm = 0.0;
+    };
+
+    void addSample (Sample);
+    void reset();
+
+    int getNumSegments() const noexcept { return (int) segments.size(); }
+
+    /** True if addSample() changed the curve since the last call to fillTempoMap(). */
+    bool hasChanged() const noexcept { return changed; }
+    void fillTempoMap (TempoMap&);
+
+private:
+    void startSegment (TempoMap::Shape, Sample from, double endBpm);
+    void mergeClosestSegments();
+
+    std::vector<TempoMap::Segment> segments;
+    Sample lastSample;
+    bool haveLastSample = false;
+    bool changed = false;
+};
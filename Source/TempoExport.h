@@ -0,0 +1,189 @@
+#pragma once
+
+// Shared-memory layout for the tempo export, plus a tiny header-only reader.
+// This header deliberately depends on nothing but the C++ standard library and
+// POSIX so companion tools can include it without pulling in JUCE.
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+#if defined (__APPLE__) || defined (__linux__)
+ #include <cerrno>
+ #include <fcntl.h>
+ #include <signal.h>
+ #include <sys/mman.h>
+ #include <sys/stat.h>
+ #include <unistd.h>
+ #define BPM2TIME_TEMPO_EXPORT_POSIX 1
+#else
+ #define BPM2TIME_TEMPO_EXPORT_POSIX 0
+#endif
+
+namespace TempoExport
+{
+    constexpr const char* segmentName = "/bpm2time.tempo";
+    constexpr uint32_t magic = 0x42504d54;  // 'BPMT'
+    constexpr uint32_t version = 2;
+
+    struct Snapshot
+    {
+        double bpm = 0.0;
+        double ppqPosition = 0.0;
+        double beatPhase = 0.0;         // 0..1 position within the current beat
+        double divisionMs = 0.0;        // Length of the selected division at this tempo
+        int32_t timeSigNumerator = 4;
+        int32_t timeSigDenominator = 4;
+        int32_t selectedDenominator = 16;
+        uint8_t isPlaying = 0;
+        uint8_t hostProvidedBpm = 0;
+        uint8_t reserved[2] {};
+    };
+
+    // The writer bumps `sequence` to an odd value, copies the snapshot, then bumps
+    // it to the next even value. Readers retry while it's odd or moved under them.
+    //
+    // `ownerPid` is the process currently publishing, or 0 if none is. Only the owner
+    // may touch anything else in the segment, so plugin instances in several processes
+    // (a DAW plus a plugin scanner, say) can't reset each other's snapshot.
+    struct Segment
+    {
+        uint32_t magic;
+        uint32_t version;
+        std::atomic<uint32_t> sequence;
+        uint32_t snapshotSize;
+        std::atomic<int32_t> ownerPid;
+        Snapshot snapshot;
+    };
+
+    static_assert (std::atomic<uint32_t>::is_always_lock_free, "Seqlock counter must be lock-free to live in shared memory");
+    static_assert (std::atomic<int32_t>::is_always_lock_free, "Owner PID must be lock-free to live in shared memory");
+
+    inline void writeSnapshot (Segment& segment, const Snapshot& snapshot) noexcept
+    {
+        const auto seq = segment.sequence.load (std::memory_order_relaxed);
+        segment.sequence.store (seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence (std::memory_order_release);
+        std::memcpy (&segment.snapshot, &snapshot, sizeof (Snapshot));
+        segment.sequence.store (seq + 2, std::memory_order_release);
+    }
+
+    inline bool readSnapshot (const Segment& segment, Snapshot& result, int maxAttempts = 64) noexcept
+    {
+        for (int attempt = 0; attempt < maxAttempts; ++attempt)
+        {
+            const auto before = segment.sequence.load (std::memory_order_acquire);
+
+            if ((before & 1u) != 0)
+                continue;
+
+            std::memcpy (&result, &segment.snapshot, sizeof (Snapshot));
+            std::atomic_thread_fence (std::memory_order_acquire);
+
+            if (segment.sequence.load (std::memory_order_relaxed) == before)
+                return true;
+        }
+
+        return false;
+    }
+
+   #if BPM2TIME_TEMPO_EXPORT_POSIX
+    inline bool isProcessAlive (int32_t pid) noexcept
+    {
+        // EPERM means the process exists but belongs to someone else
+        return pid > 0 && (::kill ((pid_t) pid, 0) == 0 || errno == EPERM);
+    }
+
+    /** Makes `pid` the segment's owner. Fails if another live process already owns it;
+        an owner that died without releasing the segment is taken over.
+    */
+    inline bool claimSegment (Segment& segment, int32_t pid) noexcept
+    {
+        auto owner = segment.ownerPid.load (std::memory_order_acquire);
+
+        for (;;)
+        {
+            if (owner == pid)
+                return true;
+
+            if (owner != 0 && isProcessAlive (owner))
+                return false;
+
+            if (segment.ownerPid.compare_exchange_weak (owner, pid, std::memory_order_acq_rel))
+                return true;
+        }
+    }
+
+    /** Gives up ownership, if `pid` has it. */
+    inline void releaseSegment (Segment& segment, int32_t pid) noexcept
+    {
+        auto expected = pid;
+        segment.ownerPid.compare_exchange_strong (expected, 0, std::memory_order_acq_rel);
+    }
+
+    /** Maps the segment read-only. read() is a zero-copy seqlock read of the mapped
+        page, so there's no IPC round trip involved once open() has succeeded.
+    */
+    class Reader
+    {
+    public:
+        Reader() = default;
+        ~Reader() { close(); }
+
+        Reader (const Reader&) = delete;
+        Reader& operator= (const Reader&) = delete;
+
+        bool open (const char* name = segmentName)
+        {
+            close();
+
+            const int fd = ::shm_open (name, O_RDONLY, 0);
+            if (fd < 0)
+                return false;
+
+            // A writer that has only just created the segment may not have sized it yet,
+            // and touching a mapping past the end of the object raises SIGBUS
+            struct stat info;
+            if (::fstat (fd, &info) != 0 || info.st_size < (off_t) sizeof (Segment))
+            {
+                ::close (fd);
+                return false;
+            }
+
+            void* mapped = ::mmap (nullptr, sizeof (Segment), PROT_READ, MAP_SHARED, fd, 0);
+            ::close (fd);
+
+            if (mapped == MAP_FAILED)
+                return false;
+
+            segment = static_cast<const Segment*> (mapped);
+
+            if (segment->magic != magic || segment->version != version || segment->snapshotSize != sizeof (Snapshot))
+            {
+                close();
+                return false;
+            }
+
+            return true;
+        }
+
+        void close()
+        {
+            if (segment != nullptr)
+                ::munmap (const_cast<Segment*> (segment), sizeof (Segment));
+            segment = nullptr;
+        }
+
+        bool isOpen() const noexcept { return segment != nullptr; }
+
+        /** Fails once the writer has stopped publishing, as well as mid-write. */
+        bool read (Snapshot& result) const noexcept
+        {
+            return segment != nullptr && segment->magic == magic && readSnapshot (*segment, result);
+        }
+
+    private:
+        const Segment* segment = nullptr;
+    };
+   #endif
+}
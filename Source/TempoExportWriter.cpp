@@ -0,0 +1,171 @@
+#include "TempoExportWriter.h"
+
+#if BPM2TIME_TEMPO_EXPORT_POSIX
+ #include <sys/stat.h>
+#endif
+
+TempoExportWriter::TempoExportWriter()
+    : juce::Thread ("BPM2Time tempo export")
+{
+}
+
+TempoExportWriter::~TempoExportWriter()
+{
+    stopThread (1000);
+    closeSegment();
+}
+
+void TempoExportWriter::prepare()
+{
+   #if BPM2TIME_TEMPO_EXPORT_POSIX
+    // Instances can be prepared on different threads in some hosts
+    const juce::ScopedLock lock (prepareLock);
+
+    if (! isThreadRunning())
+        startThread (juce::Thread::Priority::low);
+   #endif
+}
+
+bool TempoExportWriter::tryClaim (const void* owner) noexcept
+{
+    if (currentOwner.load (std::memory_order_relaxed) == owner)
+        return true;
+
+    const void* expected = nullptr;
+
+    // The writer thread notices the new owner on its next poll and opens the segment
+    return currentOwner.compare_exchange_strong (expected, owner);
+}
+
+void TempoExportWriter::release (const void* owner) noexcept
+{
+    const void* expected = owner;
+    currentOwner.compare_exchange_strong (expected, nullptr);
+}
+
+void TempoExportWriter::push (const TempoExport::Snapshot& snapshot) noexcept
+{
+    // If the writer thread falls behind we simply drop the newest snapshot;
+    // readers only ever care about the latest one anyway.
+    const auto scope = fifo.write (1);
+
+    if (scope.blockSize1 > 0)
+        pending[(size_t) scope.startIndex1] = snapshot;
+}
+
+void TempoExportWriter::run()
+{
+    // The audio thread never wakes us (signalling takes a lock), so we poll the FIFO
+    // often enough to keep readers within a few milliseconds of the host
+    constexpr int pollIntervalMs = 5;
+
+    // How often to check whether a segment owned by another process has been given up
+    constexpr juce::uint32 retryIntervalMs = 1000;
+
+    while (! threadShouldExit())
+    {
+        const bool claimed = currentOwner.load() != nullptr;
+
+        if (segment == nullptr && claimed)
+        {
+            const auto now = juce::Time::getMillisecondCounter();
+
+            if (! haveTriedToOpen || now - lastOpenAttemptMs >= retryIntervalMs)
+            {
+                haveTriedToOpen = true;
+                lastOpenAttemptMs = now;
+
+                if (openSegment())
+                    haveTriedToOpen = false;
+            }
+        }
+        else if (segment != nullptr && ! claimed)
+        {
+            // The last instance has let go, so readers shouldn't take our snapshot as current
+            closeSegment();
+        }
+
+        const int numReady = fifo.getNumReady();
+
+        if (numReady > 0)
+        {
+            // Skip straight to the most recent snapshot
+            fifo.finishedRead (numReady - 1);
+            const auto scope = fifo.read (1);
+
+            if (scope.blockSize1 > 0 && segment != nullptr)
+                TempoExport::writeSnapshot (*segment, pending[(size_t) scope.startIndex1]);
+        }
+
+        wait (pollIntervalMs);
+    }
+}
+
+bool TempoExportWriter::openSegment()
+{
+   #if BPM2TIME_TEMPO_EXPORT_POSIX
+    const int fd = ::shm_open (TempoExport::segmentName, O_CREAT | O_RDWR, 0644);
+    if (fd < 0)
+        return false;
+
+    // A segment someone else just created is still empty; one that's in use already
+    // has the right size and mustn't be resized under its owner
+    struct stat info;
+    const bool sizeOk = ::fstat (fd, &info) == 0
+                     && (info.st_size >= (off_t) sizeof (TempoExport::Segment)
+                          || ::ftruncate (fd, (off_t) sizeof (TempoExport::Segment)) == 0);
+
+    if (! sizeOk)
+    {
+        ::close (fd);
+        return false;
+    }
+
+    void* mapped = ::mmap (nullptr, sizeof (TempoExport::Segment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close (fd);
+
+    if (mapped == MAP_FAILED)
+        return false;
+
+    auto* candidate = static_cast<TempoExport::Segment*> (mapped);
+
+    if (! TempoExport::claimSegment (*candidate, (int32_t) ::getpid()))
+    {
+        ::munmap (mapped, sizeof (TempoExport::Segment));
+        return false;
+    }
+
+    segment = candidate;
+
+    // Keep the sequence counting on from the previous owner, so a reader holding an old
+    // value can't mistake our first write for an unchanged snapshot
+    const auto seq = segment->sequence.load (std::memory_order_relaxed);
+    segment->sequence.store ((seq + 1u) & ~1u, std::memory_order_relaxed);
+    segment->snapshotSize = (uint32_t) sizeof (TempoExport::Snapshot);
+    segment->version = TempoExport::version;
+    TempoExport::writeSnapshot (*segment, {});
+
+    // Written last so readers never accept a half-initialised header
+    std::atomic_thread_fence (std::memory_order_release);
+    segment->magic = TempoExport::magic;
+    return true;
+   #else
+    return false;
+   #endif
+}
+
+void TempoExportWriter::closeSegment()
+{
+   #if BPM2TIME_TEMPO_EXPORT_POSIX
+    // The segment itself is left in place: another process may open it at any moment,
+    // and unlinking it then would leave that process publishing into a dead segment.
+    // Clearing the magic tells readers nobody is publishing.
+    if (segment != nullptr)
+    {
+        segment->magic = 0;
+        TempoExport::releaseSegment (*segment, (int32_t) ::getpid());
+        ::munmap (segment, sizeof (TempoExport::Segment));
+    }
+   #endif
+    segment = nullptr;
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <JuceHeader.h>
+#include "TempoExport.h"
+
+/** Publishes tempo snapshots into the shared-memory segment described in TempoExport.h.
+
+    One writer is shared by every processor in the process. The first instance to call
+    tryClaim() becomes the publisher; the audio thread then hands snapshots over through
+    a lock-free FIFO, which a background thread polls to do the actual shared-memory
+    writes. The audio thread never signals that thread, since waking it takes a lock.
+
+    Nothing touches shared memory until an instance first claims the writer, so processes
+    that never play (plugin scanners, validators) leave the segment alone. If another
+    process already owns the segment, this one stays quiet and checks back once a second
+    in case it has gone away. When the last instance lets go, the segment's magic is
+    cleared so readers stop trusting the final snapshot.
+*/
+class TempoExportWriter : private juce::Thread
+{
+public:
+    TempoExportWriter();
+    ~TempoExportWriter() override;
+
+    // Starts the writer thread if it isn't running yet. Not for the audio thread.
+    void prepare();
+
+    // Audio thread: cheap and lock-free
+    bool tryClaim (const void* owner) noexcept;
+    void release (const void* owner) noexcept;
+    void push (const TempoExport::Snapshot& snapshot) noexcept;
+
+private:
+    void run() override;
+    bool openSegment();
+    void closeSegment();
+
+    static constexpr int fifoSize = 64;
+    juce::AbstractFifo fifo { fifoSize };
+    std::array<TempoExport::Snapshot, fifoSize> pending;
+
+    std::atomic<const void*> currentOwner { nullptr };
+    TempoExport::Segment* segment = nullptr;
+
+    // Writer thread only: when we last failed to open the segment, to retry once a second
+    bool haveTriedToOpen = false;
+    juce::uint32 lastOpenAttemptMs = 0;
+    juce::CriticalSection prepareLock;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TempoExportWriter)
+};
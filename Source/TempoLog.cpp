@@ -0,0 +1,77 @@
+#include "TempoLog.h"
+
+#if JUCE_WINDOWS
+ #include <process.h>
+#else
+ #include <unistd.h>
+#endif
+
+std::atomic<uint32_t> TempoLog::nextInstanceId { 1 };
+
+TempoLog::~TempoLog()
+{
+    // The writer thread can call didWrite() until stop() returns, so stop while this
+    // class is still intact rather than leaving it to the base class destructor
+    stop();
+}
+
+const juce::String& TempoLog::getProcessPrefix()
+{
+    static const juce::String prefix = [] {
+       #if JUCE_WINDOWS
+        const auto pid = (int) _getpid();
+       #else
+        const auto pid = (int) getpid();
+       #endif
+
+        return "bpm2time-" + juce::String (pid) + "-" + juce::Time::getCurrentTime().formatted ("%Y%m%d-%H%M%S");
+    }();
+
+    return prefix;
+}
+
+bool TempoLog::start (const juce::File& directory, double sampleRate)
+{
+    if (! directory.createDirectory())
+        return false;
+
+    header.sampleRate = sampleRate;
+    header.recordSize = (uint32_t) sizeof (TempoLogFormat::Record);
+
+    if (header.instanceId == 0)
+        header.instanceId = nextInstanceId++;
+
+    // Turning the log off and on again carries on in a numbered sibling, which rotation
+    // then works on, rather than erasing what was just recorded
+    const auto file = directory.getChildFile (getProcessPrefix() + "-" + juce::String (header.instanceId) + ".bplog");
+    return BinaryRecordWriter<TempoLogFormat::Record>::start (file, &header, sizeof (header));
+}
+
+juce::File TempoLog::getRotatedFile (int index) const
+{
+    return getFile().withFileExtension (".bplog." + juce::String (index));
+}
+
+void TempoLog::didWrite (juce::FileOutputStream& out)
+{
+    if (out.getPosition() < maxFileBytes)
+        return;
+
+    // Shuffle <name>.bplog.1 -> .2 and so on, dropping the oldest
+    stream.reset();
+
+    getRotatedFile (maxFiles - 1).deleteFile();
+
+    for (int i = maxFiles - 2; i >= 1; --i)
+        getRotatedFile (i).moveFileTo (getRotatedFile (i + 1));
+
+    getFile().moveFileTo (getRotatedFile (1));
+
+    auto fresh = std::make_unique<juce::FileOutputStream> (getFile());
+
+    if (fresh->openedOk())
+    {
+        fresh->write (&header, sizeof (header));
+        stream = std::move (fresh);
+    }
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <JuceHeader.h>
+#include "BinaryRecordWriter.h"
+#include "TempoLogFormat.h"
+
+/** Real-time safe structured log of the processor's tempo-handling decisions.
+
+    Each instance owns its own preallocated ring, which the audio thread writes fixed-size
+    records into. When logging is off, the only cost is one relaxed atomic load per call
+    site. Files rotate once they reach maxFileBytes, keeping the newest maxFiles; use
+    Tools/TempoLogDecoder.cpp to turn them back into text.
+*/
+class TempoLog : public BinaryRecordWriter<TempoLogFormat::Record>
+{
+public:
+    TempoLog() : BinaryRecordWriter<TempoLogFormat::Record> (4096) {}
+    ~TempoLog() override;
+
+    /** Message thread. Starts logging to <directory>/bpm2time-<pid>-<launch time>-<instanceId>.bplog,
+        so a relaunched host never overwrites the logs from an earlier run.
+    */
+    bool start (const juce::File& directory, double sampleRate);
+
+    static constexpr juce::int64 maxFileBytes = 4 * 1024 * 1024;
+    static constexpr int maxFiles = 4;
+
+private:
+    void didWrite (juce::FileOutputStream&) override;
+    juce::File getRotatedFile (int index) const;
+    static const juce::String& getProcessPrefix();
+
+    static std::atomic<uint32_t> nextInstanceId;
+
+    TempoLogFormat::FileHeader header;
+};
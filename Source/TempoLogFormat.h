@@ -0,0 +1,68 @@
+#pragma once
+
+// On-disk format of the tempo diagnostics log. Kept free of JUCE so the decoder in
+// Tools/ can be built with nothing but a C++17 compiler.
+
+#include <cstdint>
+
+namespace TempoLogFormat
+{
+    constexpr uint32_t magic = 0x474c5042;  // 'BPLG'
+    constexpr uint32_t version = 1;
+
+    struct FileHeader
+    {
+        uint32_t magic = TempoLogFormat::magic;
+        uint32_t version = TempoLogFormat::version;
+        double sampleRate = 0.0;
+        uint32_t instanceId = 0;
+        uint32_t recordSize = 0;
+    };
+
+    enum class Event : uint16_t
+    {
+        prepared = 1,           // prepareToPlay ran
+        bpmCheck = 2,           // checkBpmFromHost() made its decision
+        conditionedChange = 3,  // The tempo conditioner accepted a new tempo
+        missingPosition = 4     // Sync was on but the host gave no position
+    };
+
+    enum Flags : uint16_t
+    {
+        transportChanged = 1 << 0,
+        ppqMoved         = 1 << 1,
+        bpmChanged       = 1 << 2,
+        cachedBpmUpdated = 1 << 3,
+        isPlaying        = 1 << 4,
+        syncEnabled      = 1 << 5,
+        hostBpmMissing   = 1 << 6,
+        hostPpqMissing   = 1 << 7,
+        forcedCheck      = 1 << 8     // The editor asked for the check
+    };
+
+    struct Record
+    {
+        uint64_t sampleCount = 0;   // Samples processed by this instance before the event
+        double wallClockMs = 0.0;
+        uint16_t event = 0;
+        uint16_t flags = 0;
+        uint32_t blockSize = 0;
+        double hostBpm = 0.0;
+        double conditionedBpm = 0.0;
+        double cachedBpm = 0.0;
+        double ppqPosition = 0.0;
+    };
+
+    inline const char* getEventName (uint16_t event)
+    {
+        switch ((Event) event)
+        {
+            case Event::prepared:          return "prepared";
+            case Event::bpmCheck:          return "bpmCheck";
+            case Event::conditionedChange: return "conditionedChange";
+            case Event::missingPosition:   return "missingPosition";
+        }
+
+        return "unknown";
+    }
+}
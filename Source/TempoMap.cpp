@@ -0,0 +1,293 @@
+#include "TempoMap.h"
+
+namespace
+{
+    double divisionMsForTempo (double bpm, int denominator)
+    {
+        return (60000.0 / bpm) * (4.0 / static_cast<double> (denominator));
+    }
+
+    double divisionLengthInQuarters (int denominator)
+    {
+        return 4.0 / static_cast<double> (denominator);
+    }
+
+    int divisionIndexFor (int denominator)
+    {
+        for (int i = 0; i < TempoMap::numDivisions; ++i)
+            if (TempoMap::divisionDenominators[(size_t) i] == denominator)
+                return i;
+
+        return -1;
+    }
+}
+
+TempoMap TempoMap::fromHostTimeline (const std::vector<HostTempoEntry>& tempoEntries,
+                                     const std::vector<HostBarSignature>& barSignatures)
+{
+    std::vector<Segment> newSegments;
+
+    for (size_t i = 0; i + 1 < tempoEntries.size(); ++i)
+    {
+        const auto& from = tempoEntries[i];
+        const auto& to = tempoEntries[i + 1];
+        const auto seconds = to.seconds - from.seconds;
+
+        if (seconds <= 0.0)
+            continue;
+
+        Segment s;
+        s.startPpq = from.quarters;
+        s.bpm = 60.0 * (to.quarters - from.quarters) / seconds;
+        newSegments.push_back (s);
+    }
+
+    if (newSegments.empty())
+        return {};
+
+    // Split at every bar-signature change, carrying the tempo in effect at that point.
+    // Only the tempo segments are searched, not the splits added here.
+    const auto numTempoSegments = newSegments.size();
+
+    for (const auto& sig : barSignatures)
+    {
+        Segment s;
+        s.startPpq = sig.startPpq;
+        s.bpm = newSegments.front().bpm;
+
+        for (size_t i = 0; i < numTempoSegments; ++i)
+            if (newSegments[i].startPpq <= sig.startPpq)
+                s.bpm = newSegments[i].bpm;
+
+        newSegments.push_back (s);
+    }
+
+    std::stable_sort (newSegments.begin(), newSegments.end(),
+                      [] (const Segment& a, const Segment& b) { return a.startPpq < b.startPpq; });
+
+    int numerator = 4, denominator = 4;
+    size_t nextSignature = 0;
+
+    for (auto& s : newSegments)
+    {
+        while (nextSignature < barSignatures.size() && barSignatures[nextSignature].startPpq <= s.startPpq)
+        {
+            const auto& sig = barSignatures[nextSignature++];
+            numerator = sig.numerator;
+            denominator = sig.denominator;
+        }
+
+        s.timeSigNumerator = numerator;
+        s.timeSigDenominator = denominator;
+    }
+
+    TempoMap map;
+    map.setSegments (std::move (newSegments));
+    return map;
+}
+
+void TempoMap::setSegments (std::vector<Segment> newSegments)
+{
+    std::stable_sort (newSegments.begin(), newSegments.end(),
+                      [] (const Segment& a, const Segment& b) { return a.startPpq < b.startPpq; });
+
+    segments.clear();
+    segments.reserve (newSegments.size());
+
+    for (auto& s : newSegments)
+    {
+        if (s.bpm <= 0.0 || (s.shape == Shape::linearRamp && s.endBpm <= 0.0))
+            continue;
+
+        if (! segments.empty() && std::abs (segments.back().startPpq - s.startPpq) < 1.0e-9)
+            segments.back() = s;
+        else
+            segments.push_back (s);
+    }
+
+    for (size_t i = 0; i < segments.size(); ++i)
+    {
+        auto& s = segments[i];
+        s.slope = 0.0;
+
+        if (s.shape == Shape::linearRamp)
+        {
+            if (i + 1 < segments.size())
+                s.slope = (s.endBpm - s.bpm) / (segments[i + 1].startPpq - s.startPpq);
+            else
+                s.shape = Shape::constant;
+        }
+
+        for (size_t d = 0; d < (size_t) numDivisions; ++d)
+            s.divisionMs[d] = divisionMsForTempo (s.bpm, divisionDenominators[d]);
+    }
+
+    double seconds = segments.empty() ? 0.0 : segments.front().startPpq * 60.0 / segments.front().bpm;
+
+    for (size_t i = 0; i < segments.size(); ++i)
+    {
+        if (i > 0)
+            seconds += integrateSegmentMs (segments[i - 1], segments[i - 1].startPpq, segments[i].startPpq) / 1000.0;
+
+        segments[i].startSeconds = seconds;
+    }
+}
+
+int TempoMap::findSegmentIndex (double ppq) const noexcept
+{
+    auto it = std::upper_bound (segments.begin(), segments.end(), ppq,
+                                [] (double p, const Segment& s) { return p < s.startPpq; });
+
+    if (it == segments.begin())
+        return 0;
+
+    return (int) std::distance (segments.begin(), it) - 1;
+}
+
+double TempoMap::getBpmInSegment (const Segment& s, double ppq) const noexcept
+{
+    // Before the first segment there's nothing to ramp from, so hold its starting tempo
+    return s.bpm + s.slope * juce::jmax (0.0, ppq - s.startPpq);
+}
+
+double TempoMap::integrateSegmentMs (const Segment& s, double fromPpq, double toPpq) const noexcept
+{
+    double ms = 0.0;
+
+    if (fromPpq < s.startPpq)
+    {
+        const auto heldUntil = juce::jmin (toPpq, s.startPpq);
+        ms += (heldUntil - fromPpq) * 60000.0 / s.bpm;
+        fromPpq = heldUntil;
+    }
+
+    if (toPpq <= fromPpq)
+        return ms;
+
+    // d(ms)/d(ppq) = 60000 / bpm(ppq). With bpm linear in ppq this integrates to a log.
+    if (std::abs (s.slope) < 1.0e-12)
+        return ms + (toPpq - fromPpq) * 60000.0 / s.bpm;
+
+    const auto bpmFrom = getBpmInSegment (s, fromPpq);
+    const auto bpmTo   = getBpmInSegment (s, toPpq);
+    return ms + (60000.0 / s.slope) * std::log (bpmTo / bpmFrom);
+}
+
+const TempoMap::Segment* TempoMap::getSegmentAt (double ppq) const noexcept
+{
+    if (segments.empty())
+        return nullptr;
+
+    return &segments[(size_t) findSegmentIndex (ppq)];
+}
+
+const TempoMap::Segment* TempoMap::getNextChangeAfter (double ppq) const noexcept
+{
+    if (segments.empty())
+        return nullptr;
+
+    const auto index = (size_t) findSegmentIndex (ppq);
+    const auto& current = segments[index];
+
+    for (auto i = index + 1; i < segments.size(); ++i)
+    {
+        const auto& s = segments[i];
+
+        if (std::abs (s.bpm - current.bpm) > 1.0e-6
+            || s.shape == Shape::linearRamp
+            || s.timeSigNumerator != current.timeSigNumerator
+            || s.timeSigDenominator != current.timeSigDenominator)
+            return &s;
+    }
+
+    return nullptr;
+}
+
+double TempoMap::getBpmAt (double ppq, double fallbackBpm) const noexcept
+{
+    if (auto* s = getSegmentAt (ppq))
+        return getBpmInSegment (*s, ppq);
+
+    return fallbackBpm;
+}
+
+double TempoMap::getDivisionMsAt (double ppq, int denominator, double fallbackBpm) const noexcept
+{
+    const int index = divisionIndexFor (denominator);
+
+    if (auto* s = getSegmentAt (ppq))
+        if (index >= 0 && (s->shape != Shape::linearRamp || ppq <= s->startPpq))
+            return s->divisionMs[(size_t) index];
+
+    return divisionMsForTempo (getBpmAt (ppq, fallbackBpm), denominator);
+}
+
+double TempoMap::getDivisionDurationMs (double startPpq, int denominator, double fallbackBpm) const noexcept
+{
+    if (segments.empty())
+        return divisionMsForTempo (fallbackBpm, denominator);
+
+    return getDurationMs (startPpq, startPpq + divisionLengthInQuarters (denominator));
+}
+
+double TempoMap::getDurationMs (double fromPpq, double toPpq) const noexcept
+{
+    if (segments.empty() || toPpq <= fromPpq)
+        return 0.0;
+
+    double ms = 0.0;
+
+    for (auto i = (size_t) findSegmentIndex (fromPpq); i < segments.size() && fromPpq < toPpq; ++i)
+    {
+        const auto segmentEnd = i + 1 < segments.size() ? segments[i + 1].startPpq
+                                                         : std::numeric_limits<double>::infinity();
+        const auto end = juce::jmin (segmentEnd, toPpq);
+
+        ms += integrateSegmentMs (segments[i], fromPpq, end);
+        fromPpq = end;
+    }
+
+    return ms;
+}
+
+double TempoMap::getSecondsAt (double ppq) const noexcept
+{
+    if (auto* s = getSegmentAt (ppq))
+    {
+        if (ppq < s->startPpq)
+            return s->startSeconds - (s->startPpq - ppq) * 60.0 / s->bpm;
+
+        return s->startSeconds + integrateSegmentMs (*s, s->startPpq, ppq) / 1000.0;
+    }
+
+    return 0.0;
+}
+
+double TempoMap::getBarsBetween (double fromPpq, double toPpq) const noexcept
+{
+    auto quartersPerBar = [] (const Segment& s)
+    {
+        return s.timeSigDenominator > 0 ? s.timeSigNumerator * 4.0 / s.timeSigDenominator : 4.0;
+    };
+
+    if (toPpq <= fromPpq)
+        return 0.0;
+
+    // Without a map, assume 4/4
+    if (segments.empty())
+        return (toPpq - fromPpq) / 4.0;
+
+    double bars = 0.0;
+
+    for (auto i = (size_t) findSegmentIndex (fromPpq); i < segments.size() && fromPpq < toPpq; ++i)
+    {
+        const auto segmentEnd = i + 1 < segments.size() ? segments[i + 1].startPpq
+                                                         : std::numeric_limits<double>::infinity();
+        const auto end = juce::jmin (segmentEnd, toPpq);
+
+        bars += (end - fromPpq) / quartersPerBar (segments[i]);
+        fromPpq = end;
+    }
+
+    return bars;
+}
@@ -0,0 +1,106 @@
+#pragma once
+#include <JuceHeader.h>
+
+/** An indexed timeline of tempo segments covering a whole song.
+
+    Each segment starts at a PPQ position and runs until the next one. Wall-clock start
+    times and the length of every note division are precomputed when the map is built,
+    so lookups are a single binary search over the segment start positions.
+
+    Durations are found by integrating 60/bpm over the curve analytically, so they stay
+    exact across tempo ramps and tempo changes instead of assuming a constant tempo.
+*/
+class TempoMap
+{
+public:
+    static constexpr int numDivisions = 8;
+    static constexpr std::array<int, numDivisions> divisionDenominators { 128, 64, 32, 16, 8, 4, 2, 1 };
+
+    enum class Shape
+    {
+        constant,   // Holds bpm until the next segment
+        linearRamp, // Moves linearly (in PPQ) from bpm to endBpm by the next segment
+        step        // Holds bpm, and was entered by a jump rather than a ramp
+    };
+
+    struct Segment
+    {
+        double startPpq = 0.0;
+        double bpm = 120.0;
+        double endBpm = 120.0;  // Only used by linearRamp
+        Shape shape = Shape::constant;
+        int timeSigNumerator = 4;
+        int timeSigDenominator = 4;
+
+        // Filled in by setSegments()
+        double slope = 0.0;     // BPM per quarter note
+        double startSeconds = 0.0;
+        std::array<double, numDivisions> divisionMs {};  // At the tempo the segment starts with
+    };
+
+    /** A tempo entry as a host's timeline reports it (ARA's kARAContentTypeTempoEntries).
+        The tempo between two entries is constant.
+    */
+    struct HostTempoEntry
+    {
+        double seconds = 0.0;
+        double quarters = 0.0;
+    };
+
+    /** A bar signature as a host's timeline reports it (ARA's kARAContentTypeBarSignatures). */
+    struct HostBarSignature
+    {
+        double startPpq = 0.0;
+        int numerator = 4;
+        int denominator = 4;
+    };
+
+    /** Builds a map from a host's tempo entries and bar signatures. The tempo of the last
+        interval carries on past the final entry. Needs at least two tempo entries.
+    */
+    static TempoMap fromHostTimeline (const std::vector<HostTempoEntry>& tempoEntries,
+                                      const std::vector<HostBarSignature>& barSignatures);
+
+    /** Replaces the timeline. Segments are sorted and any sharing a start position are
+        collapsed, keeping the last one given. A ramp in the final segment has nowhere to
+        end, so it's held at its starting tempo.
+    */
+    void setSegments (std::vector<Segment> newSegments);
+    void clear() { segments.clear(); }
+
+    bool isEmpty() const noexcept { return segments.empty(); }
+    int getNumSegments() const noexcept { return (int) segments.size(); }
+    const Segment& getSegment (int index) const { return segments[(size_t) index]; }
+
+    /** The segment in effect at the given position, or nullptr if the map is empty.
+        Positions before the first segment use the first segment.
+    */
+    const Segment* getSegmentAt (double ppq) const noexcept;
+
+    /** The first segment whose tempo, shape or time signature differs from the one at ppq. */
+    const Segment* getNextChangeAfter (double ppq) const noexcept;
+
+    /** Instantaneous tempo at a position. */
+    double getBpmAt (double ppq, double fallbackBpm) const noexcept;
+
+    /** Division length at the instantaneous tempo, as if the tempo then stayed constant. */
+    double getDivisionMsAt (double ppq, int denominator, double fallbackBpm) const noexcept;
+
+    /** Exact wall-clock length of a division that starts at the given position. */
+    double getDivisionDurationMs (double startPpq, int denominator, double fallbackBpm) const noexcept;
+
+    /** Exact wall-clock time between two positions, integrated over the tempo curve. */
+    double getDurationMs (double fromPpq, double toPpq) const noexcept;
+
+    double getSecondsAt (double ppq) const noexcept;
+
+    /** Number of bars between two positions, following the time signature of each segment. */
+    double getBarsBetween (double fromPpq, double toPpq) const noexcept;
+
+private:
+    int findSegmentIndex (double ppq) const noexcept;
+    double getBpmInSegment (const Segment&, double ppq) const noexcept;
+    double integrateSegmentMs (const Segment&, double fromPpq, double toPpq) const noexcept;
+
+    std::vector<Segment> segments;
+};
@@ -0,0 +1,87 @@
+#include "TempoMapDocumentController.h"
+
+#if JucePlugin_Enable_ARA
+
+TempoMap TempoMapDocumentController::buildTempoMap (const juce::ARAMusicalContext& context)
+{
+    const ARA::PlugIn::HostContentReader<ARA::kARAContentTypeTempoEntries> tempoReader (&context);
+    const ARA::PlugIn::HostContentReader<ARA::kARAContentTypeBarSignatures> signatureReader (&context);
+
+    std::vector<TempoMap::HostTempoEntry> tempoEntries;
+    std::vector<TempoMap::HostBarSignature> barSignatures;
+
+    for (ARA::ARAInt32 i = 0; i < tempoReader.getEventCount(); ++i)
+    {
+        const auto& entry = tempoReader.getDataForEvent (i);
+        tempoEntries.push_back ({ entry.timePosition, entry.quarterPosition });
+    }
+
+    for (ARA::ARAInt32 i = 0; i < signatureReader.getEventCount(); ++i)
+    {
+        const auto& sig = signatureReader.getDataForEvent (i);
+        barSignatures.push_back ({ sig.position, (int) sig.numerator, (int) sig.denominator });
+    }
+
+    return TempoMap::fromHostTimeline (tempoEntries, barSignatures);
+}
+
+juce::ARADocument* TempoMapDocumentController::doCreateDocument()
+{
+    auto* document = ARADocumentControllerSpecialisation::doCreateDocument();
+    document->addListener (this);
+    return document;
+}
+
+void TempoMapDocumentController::willDestroyDocument (juce::ARADocument* document)
+{
+    document->removeListener (this);
+}
+
+juce::ARAMusicalContext* TempoMapDocumentController::doCreateMusicalContext (juce::ARADocument* document,
+                                                                             ARA::ARAMusicalContextHostRef hostRef)
+{
+    auto* context = ARADocumentControllerSpecialisation::doCreateMusicalContext (document, hostRef);
+    context->addListener (this);
+
+    // The new context's content can only be read once the host has finished this edit cycle
+    timelineContext = context;
+    timelineChanged = true;
+    return context;
+}
+
+void TempoMapDocumentController::doUpdateMusicalContextContent (juce::ARAMusicalContext* context,
+                                                                juce::ARAContentUpdateScopes scopeFlags)
+{
+    if (scopeFlags.affectTimeline())
+    {
+        timelineContext = context;
+        timelineChanged = true;
+    }
+}
+
+void TempoMapDocumentController::didEndEditing (juce::ARADocument*)
+{
+    if (timelineChanged && timelineContext != nullptr)
+        tempoMap = buildTempoMap (*timelineContext);
+
+    timelineChanged = false;
+}
+
+void TempoMapDocumentController::willDestroyMusicalContext (juce::ARAMusicalContext* context)
+{
+    context->removeListener (this);
+
+    if (context == timelineContext)
+    {
+        timelineContext = nullptr;
+        timelineChanged = false;
+        tempoMap.clear();
+    }
+}
+
+const ARA::ARAFactory* JUCE_CALLTYPE createARAFactory()
+{
+    return juce::ARADocumentControllerSpecialisation::createARAFactory<TempoMapDocumentController>();
+}
+
+#endif
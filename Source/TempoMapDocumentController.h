@@ -0,0 +1,45 @@
+#pragma once
+#include <JuceHeader.h>
+#include "TempoMap.h"
+
+#if JucePlugin_Enable_ARA
+
+/** ARA document controller that reads the host's complete tempo and bar-signature map
+    up front, rather than waiting to see the tempo one block at a time via the playhead.
+
+    The map is rebuilt on the message thread at the end of each host edit cycle in which
+    a musical context was created or its timeline changed. Hosts describe a context's
+    whole timeline when they create it, and may never send a content update afterwards.
+*/
+class TempoMapDocumentController : public juce::ARADocumentControllerSpecialisation,
+                                   private juce::ARADocument::Listener,
+                                   private juce::ARAMusicalContext::Listener
+{
+public:
+    using ARADocumentControllerSpecialisation::ARADocumentControllerSpecialisation;
+
+    const TempoMap& getTempoMap() const noexcept { return tempoMap; }
+
+    /** Converts a musical context's tempo entries and bar signatures into a TempoMap. */
+    static TempoMap buildTempoMap (const juce::ARAMusicalContext&);
+
+protected:
+    juce::ARADocument* doCreateDocument() override;
+    juce::ARAMusicalContext* doCreateMusicalContext (juce::ARADocument*, ARA::ARAMusicalContextHostRef) override;
+
+    // Nothing to persist: the tempo map always comes from the host
+    bool doRestoreObjectsFromStream (juce::ARAInputStream&, const juce::ARARestoreObjectsFilter*) override { return true; }
+    bool doStoreObjectsToStream (juce::ARAOutputStream&, const juce::ARAStoreObjectsFilter*) override { return true; }
+
+private:
+    void didEndEditing (juce::ARADocument*) override;
+    void willDestroyDocument (juce::ARADocument*) override;
+    void doUpdateMusicalContextContent (juce::ARAMusicalContext*, juce::ARAContentUpdateScopes) override;
+    void willDestroyMusicalContext (juce::ARAMusicalContext*) override;
+
+    TempoMap tempoMap;
+    juce::ARAMusicalContext* timelineContext = nullptr;  // Rebuilt from at the end of the edit cycle
+    bool timelineChanged = false;
+};
+
+#endif
@@ -0,0 +1,152 @@
+#include <JuceHeader.h>
+#include "BeatClock.h"
+
+namespace
+{
+    /** Plays a host transport at a constant tempo on a simulated clock. Each block's stamp
+        is published some time after the host's time for that block, the way a real audio
+        callback runs a little after the time the host reports for it.
+    */
+    struct SimulatedHost
+    {
+        double bpm = 120.0;
+        double sampleRate = 48000.0;
+        int blockSize = 512;
+        int64_t startNs = 3600 * (int64_t) 1000000000;  // An hour of uptime, so the clock values are realistic
+        double maxPublishDelayMs = 4.0;
+        bool providesHostTime = true;
+
+        int64_t getBlockStartNs (int block) const
+        {
+            return startNs + (int64_t) ((double) block * blockSize / sampleRate * 1.0e9);
+        }
+
+        double getTruePpq (int64_t nowNs) const
+        {
+            return (double) (nowNs - startNs) * 1.0e-9 * bpm / 60.0;
+        }
+
+        BeatStamp makeStamp (int block, juce::Random& random) const
+        {
+            const auto blockStartNs = getBlockStartNs (block);
+
+            BeatStamp stamp;
+            stamp.publishedNs = blockStartNs + (int64_t) (random.nextDouble() * maxPublishDelayMs * 1.0e6);
+            stamp.hostTimeNs = providesHostTime ? blockStartNs : 0;
+            stamp.ppqPosition = getTruePpq (blockStartNs);
+            stamp.bpm = bpm;
+            stamp.isPlaying = true;
+            return stamp;
+        }
+
+        /** Extrapolates to a display refresh at 60 Hz, over the given number of seconds, and
+            returns the worst error in milliseconds.
+        */
+        double measureWorstErrorMs (double seconds) const
+        {
+            juce::Random random (42);
+            double worstMs = 0.0;
+            int block = 0;
+            auto stamp = makeStamp (block, random);
+
+            for (int frame = 0; frame < (int) (seconds * 60.0); ++frame)
+            {
+                const auto nowNs = startNs + (int64_t) (frame * 1.0e9 / 60.0 + random.nextDouble() * 1.0e6);
+
+                // The display sees the newest stamp that has been published by now
+                for (;;)
+                {
+                    const auto next = makeStamp (block + 1, random);
+
+                    if (next.publishedNs > nowNs)
+                        break;
+
+                    stamp = next;
+                    ++block;
+                }
+
+                const auto errorQuarters = BeatClock::extrapolatePpq (stamp, nowNs) - getTruePpq (nowNs);
+                worstMs = juce::jmax (worstMs, std::abs (errorQuarters) * 60000.0 / bpm);
+            }
+
+            return worstMs;
+        }
+    };
+}
+
+class BeatClockTests : public juce::UnitTest
+{
+public:
+    BeatClockTests() : juce::UnitTest ("Beat clock", "BeatClock") {}
+
+    void runTest() override
+    {
+        beginTest ("Extrapolating from the host's time");
+        {
+            const auto worstMs = SimulatedHost().measureWorstErrorMs (60.0);
+            logMessage ("Worst extrapolation error with host time: " + juce::String (worstMs, 4) + " ms");
+            expectLessThan (worstMs, 0.01, "Extrapolation drifted from the host's position");
+        }
+
+        beginTest ("Extrapolating from the publish time when the host gives no time");
+        {
+            SimulatedHost host;
+            host.providesHostTime = false;
+
+            const auto worstMs = host.measureWorstErrorMs (60.0);
+            logMessage ("Worst extrapolation error without host time: " + juce::String (worstMs, 4) + " ms");
+            expectLessOrEqual (worstMs, host.maxPublishDelayMs + 0.01, "The error should be bounded by the publish delay");
+        }
+
+        beginTest ("A host time on another clock is ignored");
+        {
+            BeatStamp stamp;
+            stamp.publishedNs = 5000000000;
+            stamp.hostTimeNs = 123;
+            expect (BeatClock::getReferenceNs (stamp) == stamp.publishedNs);
+
+            stamp.hostTimeNs = stamp.publishedNs - 2000000;
+            expect (BeatClock::getReferenceNs (stamp) == stamp.hostTimeNs);
+        }
+
+        beginTest ("Stopped or stalled transports");
+        {
+            BeatStamp stamp;
+            stamp.publishedNs = stamp.hostTimeNs = 1000000000;
+            stamp.ppqPosition = 8.0;
+            stamp.bpm = 120.0;
+
+            expectEquals (BeatClock::extrapolatePpq (stamp, stamp.publishedNs + 500000000), 8.0);
+
+            stamp.isPlaying = true;
+            expectWithinAbsoluteError (BeatClock::extrapolatePpq (stamp, stamp.publishedNs + 500000000), 9.0, 1.0e-9);
+            expectWithinAbsoluteError (BeatClock::extrapolatePpq (stamp, stamp.publishedNs + 10000000000), 10.0, 1.0e-9);
+            expectEquals (BeatClock::extrapolatePpq (stamp, stamp.publishedNs - 500000000), 8.0);
+        }
+
+        beginTest ("Beats are counted in the time signature's denominator");
+        {
+            const auto beatAt = [] (int numerator, int denominator, double ppqIntoBar)
+            {
+                BeatStamp stamp;
+                stamp.ppqOfLastBarStart = 16.0;
+                stamp.timeSigNumerator = numerator;
+                stamp.timeSigDenominator = denominator;
+                return BeatClock::getBeatAndPhase (stamp, 16.0 + ppqIntoBar);
+            };
+
+            expectEquals (beatAt (4, 4, 2.5).first, 2);
+            expectWithinAbsoluteError (beatAt (4, 4, 2.5).second, 0.5, 1.0e-9);
+
+            // 6/8 is three quarters long with six beats
+            expectEquals (beatAt (6, 8, 2.5).first, 5);
+            expectWithinAbsoluteError (beatAt (6, 8, 2.25).second, 0.5, 1.0e-9);
+
+            expectEquals (beatAt (7, 8, 1.5).first, 3);
+            expectEquals (beatAt (2, 2, 3.0).first, 1);
+            expectWithinAbsoluteError (beatAt (2, 2, 3.0).second, 0.5, 1.0e-9);
+        }
+    }
+};
+
+static BeatClockTests beatClockTests;
@@ -0,0 +1,65 @@
+#include <JuceHeader.h>
+#include "ClockOutputGenerator.h"
+#include "TestUtilities.h"
+
+/** What the clock outputs cost on the audio thread: the time to render all three channels
+    for a block, at a few block sizes, with a loop wrapping inside some of the blocks.
+*/
+class ClockOutputBenchmark : public juce::UnitTest
+{
+public:
+    ClockOutputBenchmark() : juce::UnitTest ("Clock output generator", "Benchmarks") {}
+
+    void runTest() override
+    {
+        for (int blockSize : { 64, 512, 4096 })
+        {
+            beginTest (juce::String (blockSize) + "-sample blocks");
+            measure (blockSize);
+        }
+    }
+
+private:
+    static constexpr double sampleRate = 48000.0;
+    static constexpr int numBlocksToTime = 20000;
+
+    // Per sample of output, across all three channels
+    static constexpr double maxMeanNanosecondsPerSample = 100.0;
+
+    void measure (int blockSize)
+    {
+        FakePlayHead playHead;
+        playHead.sampleRate = sampleRate;
+        playHead.bpm = 137.0;
+        playHead.looping = true;
+        playHead.loopStartPpq = 8.0;
+        playHead.loopEndPpq = 16.0;
+
+        ClockOutputGenerator generator;
+        generator.prepare (sampleRate, blockSize);
+
+        juce::AudioBuffer<float> clockBus (3, blockSize);
+        Benchmark::Stats blockMicroseconds;
+
+        for (int block = 0; block < numBlocksToTime; ++block)
+        {
+            const auto position = playHead.getPosition();
+
+            const auto start = Benchmark::nowMicroseconds();
+            generator.process (clockBus, position, playHead.bpm, 128);
+            blockMicroseconds.add (Benchmark::nowMicroseconds() - start);
+
+            playHead.advance (blockSize);
+        }
+
+        const auto nanosecondsPerSample = blockMicroseconds.mean() * 1000.0 / blockSize;
+
+        logMessage ("Per block: " + blockMicroseconds.describe ("us"));
+        logMessage ("Per sample: " + juce::String (nanosecondsPerSample, 2) + " ns");
+
+        expectLessThan (nanosecondsPerSample, TestOptions::threshold (maxMeanNanosecondsPerSample),
+                        "Rendering the clock outputs got slower");
+    }
+};
+
+static ClockOutputBenchmark clockOutputBenchmark;
@@ -0,0 +1,172 @@
+#include <JuceHeader.h>
+#include "ClockOutputGenerator.h"
+#include "TestUtilities.h"
+
+namespace
+{
+    enum Channel { pulseChannel, rampChannel, barChannel };
+
+    /** Runs a playhead through the generator with uneven block sizes and returns the sample
+        index of every rising edge on one of its pulse channels.
+    */
+    std::vector<int64_t> renderEdges (FakePlayHead& playHead, int numSamples, int divisionDenominator, Channel channel,
+                                      int preparedBlockSize)
+    {
+        constexpr int blockSizes[] = { 512, 37, 1024, 1, 300, 999 };
+        constexpr int maxBlockSize = 1024;
+
+        ClockOutputGenerator generator;
+        generator.prepare (playHead.sampleRate, preparedBlockSize);
+
+        juce::AudioBuffer<float> clockBus (3, maxBlockSize);
+        std::vector<int64_t> edges;
+        float previous = 1.0f;  // A pulse that's already high when we start isn't an edge
+        int64_t sample = 0;
+
+        for (int block = 0; sample < numSamples; ++block)
+        {
+            const int blockSize = blockSizes[block % (int) std::size (blockSizes)];
+            clockBus.setSize (3, blockSize, false, false, true);
+            generator.process (clockBus, playHead.getPosition(), playHead.bpm, divisionDenominator);
+
+            const auto* data = clockBus.getReadPointer (channel);
+
+            for (int i = 0; i < blockSize; ++i, ++sample)
+            {
+                if (data[i] > 0.5f && previous <= 0.5f)
+                    edges.push_back (sample);
+
+                previous = data[i];
+            }
+
+            playHead.advance (blockSize);
+        }
+
+        return edges;
+    }
+
+    /** Where the edges should be: the first sample at or after each time the transport
+        crosses a multiple of gridQuarters, following the playhead's loop if it has one.
+        Times are fractional samples from the start.
+    */
+    std::vector<double> expectedEdgeTimes (const FakePlayHead& start, int numSamples, double gridQuarters)
+    {
+        const double ppqPerSample = start.bpm / (60.0 * start.sampleRate);
+        std::vector<double> times;
+        double segmentStartTime = 0.0, segmentStartPpq = start.ppq;
+
+        while (segmentStartTime < numSamples)
+        {
+            const double segmentEndPpq = start.looping ? start.loopEndPpq : std::numeric_limits<double>::max();
+            const double segmentEndTime = segmentStartTime + (segmentEndPpq - segmentStartPpq) / ppqPerSample;
+
+            for (double boundary = std::ceil (segmentStartPpq / gridQuarters) * gridQuarters;
+                 boundary < segmentEndPpq; boundary += gridQuarters)
+            {
+                const double time = segmentStartTime + (boundary - segmentStartPpq) / ppqPerSample;
+
+                if (time >= numSamples)
+                    break;
+
+                times.push_back (time);
+            }
+
+            segmentStartTime = segmentEndTime;
+            segmentStartPpq = start.loopStartPpq;
+        }
+
+        return times;
+    }
+}
+
+class ClockOutputGeneratorTests : public juce::UnitTest
+{
+public:
+    ClockOutputGeneratorTests() : juce::UnitTest ("Clock output generator", "ClockOutput") {}
+
+    void runTest() override
+    {
+        // Tempo and sample rate are chosen so that edges don't fall exactly on samples
+        FakePlayHead steady;
+        steady.sampleRate = 44100.0;
+        steady.bpm = 123.4;
+        steady.ppq = 0.1;
+
+        beginTest ("Division pulses start on the first sample of each division");
+        {
+            for (int denominator : { 4, 16, 128 })
+            {
+                auto playHead = steady;
+                checkEdges (playHead, 10 * 44100, denominator, pulseChannel, 4.0 / denominator);
+            }
+        }
+
+        beginTest ("Bar pulses start on the first sample of each bar, in the bar's metre");
+        {
+            auto playHead = steady;
+            playHead.numerator = 7;
+            playHead.denominator = 8;
+            checkEdges (playHead, 20 * 44100, 16, barChannel, 3.5);
+        }
+
+        beginTest ("Loop wraps inside a block restart the pulses at the loop start");
+        {
+            // A loop that isn't a whole number of divisions long, so the wrap cuts a division short
+            auto playHead = steady;
+            playHead.ppq = 6.1;
+            playHead.looping = true;
+            playHead.loopStartPpq = 4.0;
+            playHead.loopEndPpq = 7.9;
+
+            checkEdges (playHead, 20 * 44100, 4, pulseChannel, 1.0);
+            checkEdges (playHead, 20 * 44100, 16, pulseChannel, 0.25);
+
+            // Bar-aligned loop points
+            playHead.ppq = 6.1;
+            playHead.loopEndPpq = 12.0;
+            checkEdges (playHead, 20 * 44100, 16, barChannel, 4.0);
+        }
+
+        beginTest ("Blocks bigger than the prepared size are rendered in full");
+        {
+            // Prepared for 256 samples, while most of the blocks are bigger
+            auto playHead = steady;
+            checkEdges (playHead, 10 * 44100, 16, pulseChannel, 0.25, 256);
+
+            playHead.looping = true;
+            playHead.loopStartPpq = 4.0;
+            playHead.loopEndPpq = 7.9;
+            checkEdges (playHead, 20 * 44100, 16, barChannel, 4.0, 256);
+        }
+    }
+
+private:
+    void checkEdges (const FakePlayHead& start, int numSamples, int divisionDenominator, Channel channel, double gridQuarters,
+                     int preparedBlockSize = 1024)
+    {
+        auto playHead = start;
+        const auto edges = renderEdges (playHead, numSamples, divisionDenominator, channel, preparedBlockSize);
+        const auto expected = expectedEdgeTimes (start, numSamples, gridQuarters);
+
+        expectEquals ((int) edges.size(), (int) expected.size(), "Wrong number of edges at 1/" + juce::String (divisionDenominator));
+
+        int numMisplaced = 0;
+
+        for (size_t i = 0; i < juce::jmin (edges.size(), expected.size()); ++i)
+        {
+            // The first sample at or after the crossing, allowing for float rounding right on it
+            const auto edge = (double) edges[i];
+
+            if (edge < expected[i] - 1.0e-3 || edge >= expected[i] + 1.0 + 1.0e-3)
+            {
+                if (numMisplaced++ == 0)
+                    logMessage ("Edge " + juce::String ((int) i) + " at sample " + juce::String (edges[i])
+                                + ", expected at " + juce::String (expected[i], 3));
+            }
+        }
+
+        expectEquals (numMisplaced, 0, "Edges landed on the wrong samples at 1/" + juce::String (divisionDenominator));
+    }
+};
+
+static ClockOutputGeneratorTests clockOutputGeneratorTests;
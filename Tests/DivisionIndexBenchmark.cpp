@@ -0,0 +1,75 @@
+#include <JuceHeader.h>
+#include "DivisionIndex.h"
+#include "TestUtilities.h"
+
+/** What the Find ms lookup costs: how long creating the index holds up the thread that
+    asks for it (the message thread, the first time a time is typed), how long the
+    background build takes, the memory the table holds, and the latency of a query.
+*/
+class DivisionIndexBenchmark : public juce::UnitTest
+{
+public:
+    DivisionIndexBenchmark() : juce::UnitTest ("Division index", "Benchmarks") {}
+
+    void runTest() override
+    {
+        beginTest ("Build");
+
+        const auto rssBefore = Benchmark::getResidentBytes();
+        const auto start = Benchmark::nowMicroseconds();
+
+        DivisionIndex index;
+        const auto constructedMs = (Benchmark::nowMicroseconds() - start) / 1000.0;
+
+        expect (index.waitUntilReady (10000), "The index wasn't built within 10 seconds");
+        const auto builtMs = (Benchmark::nowMicroseconds() - start) / 1000.0;
+        const auto rssAfter = Benchmark::getResidentBytes();
+
+        logMessage ("Constructing: " + juce::String (constructedMs, 3) + " ms, then built in the background after "
+                    + juce::String (builtMs, 1) + " ms");
+        expectLessThan (constructedMs, TestOptions::threshold (maxConstructionMs), "Creating the index blocks the caller");
+
+        beginTest ("Memory");
+
+        logMessage (juce::String ((int) index.getNumEntries()) + " entries in "
+                    + Benchmark::describeBytes ((double) index.getMemoryBytes()));
+
+        if (rssAfter > 0)
+            logMessage ("Resident memory added: " + Benchmark::describeBytes ((double) rssAfter - (double) rssBefore));
+
+        expectLessThan ((double) index.getMemoryBytes(), maxTableBytes, "The table got bigger");
+
+        beginTest ("Query latency");
+
+        // Log-spaced targets across the range people type, from flams to slow delays
+        juce::Random random (42);
+        Benchmark::Stats queryMicroseconds;
+        int numWithMatches = 0;
+
+        for (int i = 0; i < numQueries; ++i)
+        {
+            const double targetMs = 5.0 * std::pow (1000.0, random.nextDouble());
+
+            const auto queryStart = Benchmark::nowMicroseconds();
+            const auto matches = index.findNearest (targetMs, 4, 1.0);
+            queryMicroseconds.add (Benchmark::nowMicroseconds() - queryStart);
+
+            if (! matches.empty())
+                ++numWithMatches;
+        }
+
+        logMessage ("Per query: " + queryMicroseconds.describe ("us"));
+        expectEquals (numWithMatches, numQueries, "Some targets found nothing within 1 ms");
+        expectLessThan (queryMicroseconds.percentile (0.99), TestOptions::threshold (maxP99QueryMicroseconds),
+                        "Queries got slower");
+    }
+
+private:
+    static constexpr int numQueries = 100000;
+
+    static constexpr double maxConstructionMs = 1.0;
+    static constexpr double maxTableBytes = 6.0 * 1024.0 * 1024.0;
+    static constexpr double maxP99QueryMicroseconds = 10.0;
+};
+
+static DivisionIndexBenchmark divisionIndexBenchmark;
@@ -0,0 +1,87 @@
+#include <JuceHeader.h>
+#include "DivisionIndex.h"
+
+class DivisionIndexTests : public juce::UnitTest
+{
+public:
+    DivisionIndexTests() : juce::UnitTest ("Division index", "Division index") {}
+
+    void runTest() override
+    {
+        DivisionIndex index;
+        expect (index.waitUntilReady (10000), "The index wasn't built within 10 seconds");
+
+        beginTest ("A time that several divisions hit exactly lists each of them once");
+        {
+            // 500 ms is 1/2, 1/4, 1/8 and 1/16 at 240, 120, 60 and 30 BPM, and four each of the
+            // dotted and triplet divisions, from 1/4. at 180 to 1/16T at 20
+            const auto matches = index.findNearest (500.0, 100, 0.001);
+            expectEquals ((int) matches.size(), 12);
+            expectDistinctDivisions (matches, "500 ms");
+
+            const auto quarter = std::find_if (matches.begin(), matches.end(), [] (const DivisionIndex::Match& m)
+            {
+                return m.denominator == 4 && m.variant == DivisionIndex::Variant::straight;
+            });
+
+            expect (quarter != matches.end(), "1/4 at 120 BPM is missing");
+
+            if (quarter != matches.end())
+                expectWithinAbsoluteError (quarter->bpm, 120.0, 1.0e-9);
+        }
+
+        beginTest ("Results are nearest first, one per division, each at that division's closest tempo");
+        {
+            juce::Random random (7);
+
+            for (int i = 0; i < 200; ++i)
+            {
+                const double targetMs = 5.0 * std::pow (1000.0, random.nextDouble());
+                const auto matches = index.findNearest (targetMs, 4, 1.0);
+                const auto description = juce::String (targetMs, 3) + " ms";
+
+                expectLessOrEqual ((int) matches.size(), 4);
+                expectDistinctDivisions (matches, description);
+
+                for (size_t m = 0; m < matches.size(); ++m)
+                {
+                    const double distance = std::abs (matches[m].durationMs - targetMs);
+                    expectLessOrEqual (distance, 1.0, description);
+                    expectWithinAbsoluteError (distance, closestDistance (matches[m], targetMs), 1.0e-3, description);
+
+                    if (m > 0)
+                        expectGreaterOrEqual (distance, std::abs (matches[m - 1].durationMs - targetMs), description);
+                }
+            }
+        }
+    }
+
+private:
+    void expectDistinctDivisions (const std::vector<DivisionIndex::Match>& matches, const juce::String& description)
+    {
+        juce::StringArray names;
+
+        for (const auto& m : matches)
+            names.add (m.getDivisionName());
+
+        const int numListed = names.size();
+        names.removeDuplicates (false);
+        expectEquals (names.size(), numListed, "A division is listed twice for " + description);
+    }
+
+    /** How close the best tempo in the range gets a match's division to the target. */
+    static double closestDistance (const DivisionIndex::Match& match, double targetMs)
+    {
+        const double factor = match.variant == DivisionIndex::Variant::dotted  ? 1.5
+                            : match.variant == DivisionIndex::Variant::triplet ? 2.0 / 3.0
+                                                                               : 1.0;
+        double best = std::numeric_limits<double>::max();
+
+        for (double bpm = DivisionIndex::minBpm; bpm <= DivisionIndex::maxBpm + 1.0e-9; bpm += DivisionIndex::bpmStep)
+            best = juce::jmin (best, std::abs (240000.0 / (bpm * match.denominator) * factor - targetMs));
+
+        return best;
+    }
+};
+
+static DivisionIndexTests divisionIndexTests;
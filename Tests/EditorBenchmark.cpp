@@ -0,0 +1,98 @@
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+#include "TestUtilities.h"
+
+/** What opening editors costs: the time from asking for an editor to having it painted
+    once, and the resident memory each open editor holds. The first editor in the process
+    also builds the shared look-and-feel, so it's reported separately.
+*/
+class EditorBenchmark : public juce::UnitTest
+{
+public:
+    EditorBenchmark() : juce::UnitTest ("Editor open", "Benchmarks") {}
+
+    void runTest() override
+    {
+        for (int numEditors : { 1, 50, 200 })
+        {
+            if (numEditors > TestOptions::get().maxInstances)
+                continue;
+
+            beginTest (juce::String (numEditors) + (numEditors == 1 ? " editor" : " editors"));
+            measureEditors (numEditors);
+        }
+    }
+
+private:
+    static constexpr double sampleRate = 48000.0;
+    static constexpr int blockSize = 512;
+
+    static constexpr double maxMeanOpenMs = 20.0;
+    static constexpr double maxBytesPerEditor = 1024.0 * 1024.0;
+
+    void measureEditors (int numEditors)
+    {
+        std::vector<std::unique_ptr<PassthroughTempoProcessor>> processors;
+
+        for (int i = 0; i < numEditors; ++i)
+        {
+            processors.push_back (std::make_unique<PassthroughTempoProcessor>());
+            processors.back()->setRateAndBufferSizeDetails (sampleRate, blockSize);
+            processors.back()->prepareToPlay (sampleRate, blockSize);
+        }
+
+        std::vector<std::unique_ptr<juce::AudioProcessorEditor>> editors;
+        Benchmark::Stats openMs;
+        double firstOpenMs = 0.0;
+
+        const auto rssBefore = Benchmark::getResidentBytes();
+
+        for (auto& processor : processors)
+        {
+            const auto start = Benchmark::nowMicroseconds();
+
+            std::unique_ptr<juce::AudioProcessorEditor> editor (processor->createEditorIfNeeded());
+            const auto snapshot = editor->createComponentSnapshot (editor->getLocalBounds());
+
+            const auto elapsedMs = (Benchmark::nowMicroseconds() - start) / 1000.0;
+
+            if (editors.empty())
+                firstOpenMs = elapsedMs;
+            else
+                openMs.add (elapsedMs);
+
+            editors.push_back (std::move (editor));
+        }
+
+        const auto rssAfter = Benchmark::getResidentBytes();
+        const auto bytesPerEditor = ((double) rssAfter - (double) rssBefore) / numEditors;
+
+        const auto closeStart = Benchmark::nowMicroseconds();
+        editors.clear();
+        const auto closeMs = (Benchmark::nowMicroseconds() - closeStart) / 1000.0;
+
+        logMessage ("First editor open: " + juce::String (firstOpenMs, 2) + " ms");
+
+        if (numEditors > 1)
+            logMessage ("Further editors: " + openMs.describe ("ms"));
+
+        logMessage ("Closing all of them: " + juce::String (closeMs, 2) + " ms");
+
+        if (rssAfter > 0)
+            logMessage ("Resident memory per editor: " + Benchmark::describeBytes (bytesPerEditor)
+                        + (numEditors == 1 ? " (including the shared look-and-feel)" : ""));
+
+        if (numEditors > 1)
+        {
+            expectLessThan (openMs.mean(), TestOptions::threshold (maxMeanOpenMs), "Editors take too long to open");
+
+            if (rssAfter > 0)
+                expectLessThan (bytesPerEditor, TestOptions::threshold (maxBytesPerEditor), "Each editor holds too much memory");
+        }
+
+        for (auto& processor : processors)
+            processor->releaseResources();
+    }
+};
+
+static EditorBenchmark editorBenchmark;
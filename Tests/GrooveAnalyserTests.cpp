@@ -0,0 +1,228 @@
+#include <JuceHeader.h>
+#include "GrooveAnalyser.h"
+#include "PluginProcessor.h"
+#include "TestUtilities.h"
+
+class GrooveAnalyserTests : public juce::UnitTest
+{
+public:
+    GrooveAnalyserTests() : juce::UnitTest ("Groove analyser", "Groove") {}
+
+    void runTest() override
+    {
+        beginTest ("A hit is placed on its first sample on either side of a stereo pair");
+        {
+            for (int channel : { 0, 1 })
+            {
+                const auto hits = findHits (channel, 1000);
+                expectEquals ((int) hits.size(), 1);
+
+                if (! hits.empty())
+                    expectWithinAbsoluteError (hits.front().offsetSamples, 1000.0f - 960.0f, 0.01f,
+                                               "Hit on channel " + juce::String (channel) + " was misplaced");
+            }
+        }
+
+        beginTest ("A hit that starts at the end of one block and carries on into the next is found once");
+        {
+            // 1000-sample blocks leave a short hop at the end of each, and the click starts in it
+            GrooveAnalyser analyser;
+            analyser.prepare (sampleRate);
+
+            std::vector<GrooveHit> hits;
+
+            for (int block = 0; block < 2; ++block)
+            {
+                auto buffer = makeBlock (1000, 0, block == 0 ? 990 : -10);
+                analyser.process (buffer, 2, positionAt (block * 1000 / samplesPerQuarter), 16);
+                analyser.popHits ([&] (const GrooveHit& hit) { hits.push_back (hit); });
+            }
+
+            expectEquals ((int) hits.size(), 1);
+
+            if (! hits.empty())
+            {
+                expectWithinAbsoluteError (hits.front().offsetSamples, 990.0f - 960.0f, 0.01f);
+                expectWithinAbsoluteError (hits.front().ppqPosition, 990.0 / samplesPerQuarter, 1.0e-9);
+            }
+        }
+
+        beginTest ("After the transport jumps, hits are measured from where it landed");
+        {
+            GrooveAnalyser analyser;
+            analyser.prepare (sampleRate);
+
+            std::vector<GrooveHit> hits;
+
+            for (double blockPpq : { 0.0, 37.0, 5.125 })
+            {
+                auto buffer = makeBlock (4096, 0, 1000);
+                analyser.process (buffer, 2, positionAt (blockPpq), 16);
+                analyser.popHits ([&] (const GrooveHit& hit) { hits.push_back (hit); });
+            }
+
+            expectEquals ((int) hits.size(), 3);
+
+            if (hits.size() == 3)
+            {
+                expectWithinAbsoluteError (hits[1].ppqPosition, 37.0 + 1000.0 / samplesPerQuarter, 1.0e-9);
+                expectWithinAbsoluteError (hits[1].offsetSamples, 1000.0f - 960.0f, 0.01f);
+
+                // The block starts half-way between two 1/16 lines, so the click is 480 + 1000
+                // samples past one line, which is 520 past the next and 440 early for the one after
+                expectWithinAbsoluteError (hits[2].ppqPosition, 5.125 + 1000.0 / samplesPerQuarter, 1.0e-9);
+                expectWithinAbsoluteError (hits[2].offsetSamples, -440.0f, 0.01f);
+            }
+        }
+
+        beginTest ("Hits land in the bin for their share of the grid");
+        {
+            GrooveHistogram histogram;
+            constexpr int centre = GrooveHistogram::numBins / 2;
+
+            histogram.add (hitAt (0.0f, 0.0f));
+            histogram.add (hitAt (-0.5f, 0.0f));
+            histogram.add (hitAt (0.5f, 0.0f));       // The far edge is clamped into the last bin
+            histogram.add (hitAt (0.49f, 0.0f));
+            histogram.add (hitAt (-0.5f + 1.5f / GrooveHistogram::numBins, 0.0f));
+
+            expectEquals (histogram.getNumHits(), 5);
+            expectEquals (histogram.getBinCount (centre), 1);
+            expectEquals (histogram.getBinCount (0), 1);
+            expectEquals (histogram.getBinCount (1), 1);
+            expectEquals (histogram.getBinCount (GrooveHistogram::numBins - 1), 2);
+            expectEquals (histogram.getMaxBinCount(), 2);
+        }
+
+        beginTest ("The mean is the average offset and the spread its standard deviation");
+        {
+            GrooveHistogram histogram;
+            expectEquals (histogram.getMeanOffsetMs(), 0.0f);
+
+            histogram.add (hitAt (0.1f, 3.0f));
+            expectEquals (histogram.getSpreadMs(), 0.0f, "One hit has no spread");
+
+            histogram.clear();
+
+            for (float ms : { 2.0f, 4.0f, 4.0f, 4.0f, 5.0f, 5.0f, 7.0f, 9.0f })
+                histogram.add (hitAt (ms / 100.0f, ms));
+
+            expectWithinAbsoluteError (histogram.getMeanOffsetMs(), 5.0f, 1.0e-5f);
+            expectWithinAbsoluteError (histogram.getSpreadMs(), 2.0f, 1.0e-5f);
+        }
+
+        beginTest ("Once the history is full, each new hit replaces the oldest");
+        {
+            GrooveHistogram histogram;
+            constexpr int lateBin = 15, earlyBin = 5;     // +/- a quarter of the grid
+
+            for (int i = 0; i < GrooveHistogram::historySize; ++i)
+                histogram.add (hitAt (0.25f, 10.0f));
+
+            for (int i = 0; i < 100; ++i)
+                histogram.add (hitAt (-0.25f, -10.0f));
+
+            constexpr int numLate = GrooveHistogram::historySize - 100;
+            expectEquals (histogram.getNumHits(), GrooveHistogram::historySize);
+            expectEquals (histogram.getBinCount (lateBin), numLate);
+            expectEquals (histogram.getBinCount (earlyBin), 100);
+            expectWithinAbsoluteError (histogram.getMeanOffsetMs(),
+                                       (float) (numLate - 100) * 10.0f / (float) GrooveHistogram::historySize, 1.0e-4f);
+
+            for (int i = 0; i < GrooveHistogram::historySize; ++i)
+                histogram.add (hitAt (-0.25f, -10.0f));
+
+            expectEquals (histogram.getBinCount (lateBin), 0);
+            expectEquals (histogram.getBinCount (earlyBin), GrooveHistogram::historySize);
+            expectWithinAbsoluteError (histogram.getMeanOffsetMs(), -10.0f, 1.0e-4f);
+            expectWithinAbsoluteError (histogram.getSpreadMs(), 0.0f, 1.0e-2f);
+        }
+
+        beginTest ("Hits queued while no editor was open are dropped when one opens");
+        {
+            FakePlayHead playHead;
+            playHead.sampleRate = sampleRate;
+            playHead.bpm = 750.0;
+
+            PassthroughTempoProcessor processor;
+            processor.apvts.getParameter ("grooveAnalysis")->setValueNotifyingHost (1.0f);
+            processor.setPlayHead (&playHead);
+            processor.setRateAndBufferSizeDetails (sampleRate, 4096);
+            processor.prepareToPlay (sampleRate, 4096);
+
+            juce::MidiBuffer midi;
+
+            auto playClicks = [&] (int numBlocks)
+            {
+                for (int i = 0; i < numBlocks; ++i)
+                {
+                    auto buffer = makeBlock (4096, 0, 1000);
+                    processor.processBlock (buffer, midi);
+                    playHead.advance (4096);
+                }
+            };
+
+            playClicks (10);
+            processor.discardQueuedGrooveHits();
+            processor.processQueuedAnalysis();
+            expectEquals (processor.getGrooveHistogram().getNumHits(), 0);
+
+            playClicks (3);
+            processor.processQueuedAnalysis();
+            expectEquals (processor.getGrooveHistogram().getNumHits(), 3);
+        }
+    }
+
+private:
+    static constexpr double sampleRate = 48000.0;
+    static constexpr double samplesPerQuarter = 3840.0;    // At 750 BPM, so 1/16 = 960 samples
+
+    /** A stereo block of silence with a 32-sample click on one channel. The click can start
+        before the block, in which case only its tail is in it.
+    */
+    static juce::AudioBuffer<float> makeBlock (int numSamples, int channel, int clickStart)
+    {
+        juce::AudioBuffer<float> buffer (2, numSamples);
+        buffer.clear();
+
+        for (int i = juce::jmax (0, clickStart); i < juce::jmin (numSamples, clickStart + 32); ++i)
+            buffer.setSample (channel, i, 0.8f);
+
+        return buffer;
+    }
+
+    static juce::AudioPlayHead::PositionInfo positionAt (double ppq)
+    {
+        juce::AudioPlayHead::PositionInfo pos;
+        pos.setIsPlaying (true);
+        pos.setBpm (750.0);
+        pos.setPpqPosition (ppq);
+        return pos;
+    }
+
+    static GrooveHit hitAt (float gridFraction, float offsetMs)
+    {
+        GrooveHit hit;
+        hit.gridFraction = gridFraction;
+        hit.offsetMs = offsetMs;
+        return hit;
+    }
+
+    /** Runs a block of silence with one click in it past the analyser, on a 1/16 grid that
+        has a line every 960 samples, and returns what it found.
+    */
+    std::vector<GrooveHit> findHits (int channel, int clickSample)
+    {
+        GrooveAnalyser analyser;
+        analyser.prepare (sampleRate);
+
+        auto buffer = makeBlock (4096, channel, clickSample);
+        analyser.process (buffer, 2, positionAt (0.0), 16);
+
+        std::vector<GrooveHit> hits;
+        analyser.popHits ([&] (const GrooveHit& hit) { hits.push_back (hit); });
+        return hits;
+    }
+};
+
+static GrooveAnalyserTests grooveAnalyserTests;
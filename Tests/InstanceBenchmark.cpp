@@ -0,0 +1,116 @@
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+#include "TestUtilities.h"
+
+/** What each plugin instance costs a host: how long the plugin binary takes to load, how
+    long an instance takes from construction to its first processed block, and how much
+    resident memory it holds. Runs from 1 up to --max-instances instances.
+*/
+class InstanceBenchmark : public juce::UnitTest
+{
+public:
+    InstanceBenchmark() : juce::UnitTest ("Instance footprint", "Benchmarks") {}
+
+    void runTest() override
+    {
+        beginTest ("Cold load");
+        measureColdLoad();
+
+        // Largest first: later, smaller runs reuse memory freed by earlier ones, so only
+        // the first run's resident memory is a clean per-instance figure
+        bool first = true;
+
+        for (int numInstances : { 1000, 100, 10, 1 })
+        {
+            if (numInstances > TestOptions::get().maxInstances)
+                continue;
+
+            beginTest (juce::String (numInstances) + (numInstances == 1 ? " instance" : " instances"));
+            measureInstances (numInstances, first);
+            first = false;
+        }
+    }
+
+private:
+    static constexpr double sampleRate = 48000.0;
+    static constexpr int blockSize = 512;
+
+    static constexpr double maxMeanFirstBlockMs = 2.0;
+    static constexpr double maxBytesPerInstance = 256.0 * 1024.0;
+
+    void measureColdLoad()
+    {
+        const auto& binary = TestOptions::get().pluginBinary;
+
+        if (binary == juce::File())
+        {
+            logMessage ("Pass --plugin <path to the built plugin's binary> to time a cold load");
+            return;
+        }
+
+        const auto rssBefore = Benchmark::getResidentBytes();
+        const auto start = Benchmark::nowMicroseconds();
+
+        juce::DynamicLibrary library;
+        const bool opened = library.open (binary.getFullPathName());
+
+        const auto elapsedMs = (Benchmark::nowMicroseconds() - start) / 1000.0;
+        expect (opened, "Couldn't load " + binary.getFullPathName());
+
+        logMessage ("Loading " + binary.getFileName() + " took " + juce::String (elapsedMs, 2) + " ms and "
+                    + Benchmark::describeBytes ((double) Benchmark::getResidentBytes() - (double) rssBefore));
+    }
+
+    void measureInstances (int numInstances, bool checkMemory)
+    {
+        std::vector<FakePlayHead> playHeads ((size_t) numInstances);
+        std::vector<std::unique_ptr<PassthroughTempoProcessor>> processors;
+        processors.reserve ((size_t) numInstances);
+
+        juce::AudioBuffer<float> buffer (2, blockSize);
+        juce::MidiBuffer midi;
+        Benchmark::Stats constructMs, firstBlockMs;
+
+        const auto rssBefore = Benchmark::getResidentBytes();
+
+        for (auto& playHead : playHeads)
+        {
+            const auto start = Benchmark::nowMicroseconds();
+            auto processor = std::make_unique<PassthroughTempoProcessor>();
+            const auto constructed = Benchmark::nowMicroseconds();
+
+            processor->setPlayHead (&playHead);
+            processor->setRateAndBufferSizeDetails (sampleRate, blockSize);
+            processor->prepareToPlay (sampleRate, blockSize);
+            buffer.clear();
+            processor->processBlock (buffer, midi);
+            const auto processed = Benchmark::nowMicroseconds();
+
+            constructMs.add ((constructed - start) / 1000.0);
+            firstBlockMs.add ((processed - start) / 1000.0);
+            processors.push_back (std::move (processor));
+        }
+
+        const auto rssAfter = Benchmark::getResidentBytes();
+        const auto bytesPerInstance = ((double) rssAfter - (double) rssBefore) / numInstances;
+
+        logMessage ("Construction: " + constructMs.describe ("ms"));
+        logMessage ("Construction to first block: " + firstBlockMs.describe ("ms"));
+
+        if (checkMemory)
+            logMessage (rssAfter > 0 ? "Resident memory per instance: " + Benchmark::describeBytes (bytesPerInstance)
+                                     : juce::String ("Resident memory can't be measured on this platform"));
+
+        expectLessThan (firstBlockMs.mean(), TestOptions::threshold (maxMeanFirstBlockMs),
+                        "Instances take too long to reach their first block");
+
+        if (checkMemory && rssAfter > 0)
+            expectLessThan (bytesPerInstance, TestOptions::threshold (maxBytesPerInstance),
+                            "Each instance holds too much memory");
+
+        for (auto& processor : processors)
+            processor->releaseResources();
+    }
+};
+
+static InstanceBenchmark instanceBenchmark;
@@ -0,0 +1,315 @@
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+#include "TestUtilities.h"
+
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace
+{
+    /** Spreads tasks over a set of threads the way hosts with a multi-core audio engine
+        spread plugin instances: each thread has its own queue, and a thread that runs out
+        of work steals from the back of the others' queues. The calling thread works too.
+    */
+    class WorkStealingPool
+    {
+    public:
+        explicit WorkStealingPool (int numThreads)
+            : queues ((size_t) juce::jmax (1, numThreads))
+        {
+            for (int i = 1; i < (int) queues.size(); ++i)
+                workers.emplace_back ([this, i] { workerLoop (i); });
+        }
+
+        ~WorkStealingPool()
+        {
+            quit = true;
+
+            for (auto& worker : workers)
+                worker.join();
+        }
+
+        /** Runs task (i) for every i in [0, numTasks) and returns once they've all finished. */
+        void run (int numTasks, std::function<void (int)> newTask)
+        {
+            // Workers finishing off the previous run can pick up new tasks as soon as they're
+            // queued, so everything they need is set up before the first push
+            task = std::move (newTask);
+            remaining.store (numTasks, std::memory_order_relaxed);
+
+            for (int i = 0; i < numTasks; ++i)
+            {
+                auto& queue = queues[(size_t) i % queues.size()];
+                const std::lock_guard<std::mutex> lock (queue.lock);
+                queue.tasks.push_back (i);
+            }
+
+            generation.fetch_add (1, std::memory_order_release);
+            work (0);
+
+            while (remaining.load (std::memory_order_acquire) > 0)
+                std::this_thread::yield();
+        }
+
+    private:
+        struct alignas (128) Queue
+        {
+            std::mutex lock;
+            std::deque<int> tasks;
+        };
+
+        void workerLoop (int index)
+        {
+            uint64_t lastGeneration = 0;
+
+            while (! quit.load (std::memory_order_relaxed))
+            {
+                const auto current = generation.load (std::memory_order_acquire);
+
+                if (current == lastGeneration)
+                {
+                    std::this_thread::yield();
+                    continue;
+                }
+
+                lastGeneration = current;
+                work (index);
+            }
+        }
+
+        bool popOwn (int index, int& taskIndex)
+        {
+            auto& queue = queues[(size_t) index];
+            const std::lock_guard<std::mutex> lock (queue.lock);
+
+            if (queue.tasks.empty())
+                return false;
+
+            taskIndex = queue.tasks.front();
+            queue.tasks.pop_front();
+            return true;
+        }
+
+        bool steal (int thief, int& taskIndex)
+        {
+            for (size_t offset = 1; offset < queues.size(); ++offset)
+            {
+                auto& queue = queues[((size_t) thief + offset) % queues.size()];
+                const std::lock_guard<std::mutex> lock (queue.lock);
+
+                if (! queue.tasks.empty())
+                {
+                    taskIndex = queue.tasks.back();
+                    queue.tasks.pop_back();
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        void work (int index)
+        {
+            int taskIndex = 0;
+
+            while (popOwn (index, taskIndex) || steal (index, taskIndex))
+            {
+                task (taskIndex);
+                remaining.fetch_sub (1, std::memory_order_acq_rel);
+            }
+        }
+
+        std::vector<Queue> queues;
+        std::vector<std::thread> workers;
+        std::function<void (int)> task;
+        std::atomic<int> remaining { 0 };
+        std::atomic<uint64_t> generation { 0 };
+        std::atomic<bool> quit { false };
+    };
+
+    /** One plugin instance with its own transport and buffers, as a host would give it. */
+    struct Instance
+    {
+        FakePlayHead playHead;
+        PassthroughTempoProcessor processor;
+        juce::AudioBuffer<float> buffer;
+        juce::MidiBuffer midi;
+    };
+}
+
+/** How well instances scale across cores: many instances, each with its own playhead,
+    processed from a work-stealing pool at every thread count from one up to one per core.
+
+    A second run adds a thread standing in for the message thread, reading every
+    instance the way an open editor does. Anything the audio thread writes that shares a
+    cache line with what that thread reads shows up as lost throughput.
+*/
+class ParallelInstanceBenchmark : public juce::UnitTest
+{
+public:
+    ParallelInstanceBenchmark() : juce::UnitTest ("Parallel instances", "Benchmarks") {}
+
+    void runTest() override
+    {
+        const int numInstances = juce::jmin (TestOptions::get().maxInstances, 256);
+        // Hyperthreads share a core's execution units, so they'd count against the scaling
+        // for reasons that have nothing to do with how instances share memory
+        const int numCores = juce::SystemStats::getNumPhysicalCpus();
+        createInstances (numInstances);
+
+        std::vector<int> threadCounts;
+
+        for (int n = 1; n < numCores; n *= 2)
+            threadCounts.push_back (n);
+
+        threadCounts.push_back (numCores);
+
+        double singleThreadRate = 0.0, allCoresRate = 0.0;
+
+        for (auto numThreads : threadCounts)
+        {
+            beginTest (juce::String (numInstances) + " instances on " + juce::String (numThreads)
+                       + (numThreads == 1 ? " thread" : " threads"));
+
+            const auto rate = measureBlocksPerSecond (numThreads, false);
+
+            if (numThreads == 1)
+                singleThreadRate = rate;
+
+            allCoresRate = rate;
+
+            const auto speedup = rate / singleThreadRate;
+            logMessage (juce::String (rate, 0) + " blocks/s, " + juce::String (speedup, 2) + "x one thread, "
+                        + juce::String (100.0 * speedup / numThreads, 0) + "% efficiency");
+        }
+
+        beginTest ("Scaling to every core");
+
+        if (numCores > 1)
+            expectGreaterOrEqual (allCoresRate / singleThreadRate / numCores,
+                                  minParallelEfficiency / TestOptions::get().thresholdScale,
+                                  "Instances don't scale across cores");
+        else
+            logMessage ("Only one core, so scaling can't be measured");
+
+        beginTest ("Editors reading every instance while they run");
+
+        if (numCores > 1)
+        {
+            // Leave the reader a core of its own, like a message thread
+            const auto alone = measureBlocksPerSecond (numCores - 1, false);
+            const auto withReader = measureBlocksPerSecond (numCores - 1, true);
+            const auto slowdown = 1.0 - withReader / alone;
+
+            logMessage ("Throughput with a reader: " + juce::String (100.0 * slowdown, 1) + "% lower");
+            expectLessThan (slowdown, TestOptions::threshold (maxReaderSlowdown),
+                            "Reading from the message thread slows the audio threads down");
+        }
+        else
+        {
+            logMessage ("Only one core, so the reader can't have its own");
+        }
+
+        instances.clear();
+    }
+
+private:
+    static constexpr double sampleRate = 48000.0;
+    static constexpr int blockSize = 512;
+    static constexpr int numCycles = 100;
+
+    // A single block takes a few microseconds, about what the pool spends handing out a
+    // task, so each task runs several blocks to keep the measurement about the instances
+    static constexpr int blocksPerTask = 8;
+
+    static constexpr double minParallelEfficiency = 0.5;
+    static constexpr double maxReaderSlowdown = 0.15;
+
+    std::vector<std::unique_ptr<Instance>> instances;
+
+    void createInstances (int numInstances)
+    {
+        instances.clear();
+
+        for (int i = 0; i < numInstances; ++i)
+        {
+            auto instance = std::make_unique<Instance>();
+            instance->playHead.bpm = 90.0 + i % 60;
+            instance->buffer.setSize (2, blockSize);
+            instance->buffer.clear();
+
+            // Half the instances run groove analysis as well, so the per-block work isn't all the same
+            if (i % 2 == 1)
+                if (auto* groove = instance->processor.apvts.getParameter ("grooveAnalysis"))
+                    groove->setValueNotifyingHost (1.0f);
+
+            instance->processor.setPlayHead (&instance->playHead);
+            instance->processor.setRateAndBufferSizeDetails (sampleRate, blockSize);
+            instance->processor.prepareToPlay (sampleRate, blockSize);
+            instances.push_back (std::move (instance));
+        }
+    }
+
+    double measureBlocksPerSecond (int numThreads, bool withReader)
+    {
+        WorkStealingPool pool (numThreads);
+        const auto processInstance = [this] (int index)
+        {
+            auto& instance = *instances[(size_t) index];
+
+            for (int block = 0; block < blocksPerTask; ++block)
+            {
+                instance.processor.processBlock (instance.buffer, instance.midi);
+                instance.playHead.advance (blockSize);
+            }
+        };
+
+        std::atomic<bool> stopReading { false };
+        std::thread reader;
+
+        if (withReader)
+        {
+            reader = std::thread ([this, &stopReading]
+            {
+                double sink = 0.0;
+                BeatStamp stamp;
+
+                while (! stopReading.load (std::memory_order_relaxed))
+                {
+                    for (auto& instance : instances)
+                    {
+                        auto& processor = instance->processor;
+                        processor.processQueuedAnalysis();
+                        sink += processor.getCachedBpm() + processor.getLastPpqPosition() + (processor.hostProvidedBpm() ? 1.0 : 0.0);
+
+                        if (processor.getBeatClock().read (stamp))
+                            sink += stamp.ppqPosition;
+                    }
+                }
+
+                juce::ignoreUnused (sink);
+            });
+        }
+
+        for (int cycle = 0; cycle < numCycles / 10; ++cycle)
+            pool.run ((int) instances.size(), processInstance);
+
+        const auto start = Benchmark::nowMicroseconds();
+
+        for (int cycle = 0; cycle < numCycles; ++cycle)
+            pool.run ((int) instances.size(), processInstance);
+
+        const auto elapsedSeconds = (Benchmark::nowMicroseconds() - start) * 1.0e-6;
+
+        if (reader.joinable())
+        {
+            stopReading = true;
+            reader.join();
+        }
+
+        return (double) numCycles * blocksPerTask * (double) instances.size() / elapsedSeconds;
+    }
+};
+
+static ParallelInstanceBenchmark parallelInstanceBenchmark;
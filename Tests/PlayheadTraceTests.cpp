@@ -0,0 +1,86 @@
+#include <JuceHeader.h>
+#include "PlayheadTrace.h"
+#include "PluginProcessor.h"
+#include "TestUtilities.h"
+
+class PlayheadTraceTests : public juce::UnitTest
+{
+public:
+    PlayheadTraceTests() : juce::UnitTest ("Playhead trace", "PlayheadTrace") {}
+
+    void runTest() override
+    {
+        // A ramp with host jitter on top, so the conditioner and the BPM checks both have work to do
+        juce::Random random (32);
+        juce::TemporaryFile traceFile (".bptrace");
+        TestTrace::write (traceFile.getFile(), 4000, [&] (int i)
+        {
+            return 100.0 + juce::jmin (i, 2000) * 0.01 + (random.nextDouble() - 0.5) * 1.0e-5;
+        });
+
+        PlayheadTrace::Replayer replayer;
+        expect (replayer.load (traceFile.getFile()));
+
+        beginTest ("Replaying a trace gives the same results every time");
+        {
+            PassthroughTempoProcessor first, second;
+            const auto a = replayer.replay (first);
+            const auto b = replayer.replay (second);
+
+            expectEquals ((int) a.size(), 4000);
+            expectEquals ((int) b.size(), (int) a.size());
+
+            int numDifferences = 0;
+
+            for (size_t i = 0; i < juce::jmin (a.size(), b.size()); ++i)
+                if (a[i].numSamples != b[i].numSamples || a[i].effectiveBpm != b[i].effectiveBpm
+                    || a[i].cachedBpm != b[i].cachedBpm || a[i].hostProvidedBpm != b[i].hostProvidedBpm)
+                    ++numDifferences;
+
+            expectEquals (numDifferences, 0, "Two replays of the same trace disagreed");
+
+            expect (! a.empty() && a.back().hostProvidedBpm);
+            expectWithinAbsoluteError (a.back().effectiveBpm, 120.0, 0.01);
+        }
+
+        beginTest ("Replaying a trace twice on one processor gives the same results");
+        {
+            PassthroughTempoProcessor processor;
+            const auto a = replayer.replay (processor);
+            const auto b = replayer.replay (processor);
+
+            expectEquals ((int) b.size(), (int) a.size());
+
+            int numDifferences = 0;
+
+            for (size_t i = 0; i < juce::jmin (a.size(), b.size()); ++i)
+                if (a[i].numSamples != b[i].numSamples || a[i].effectiveBpm != b[i].effectiveBpm
+                    || a[i].cachedBpm != b[i].cachedBpm || a[i].hostProvidedBpm != b[i].hostProvidedBpm)
+                    ++numDifferences;
+
+            expectEquals (numDifferences, 0, "The second replay started from the first one's state");
+        }
+
+       #if ! JUCE_WINDOWS
+        beginTest ("Replays don't capture or log, even when the environment asks for it");
+        {
+            auto dir = juce::File::getSpecialLocation (juce::File::tempDirectory).getNonexistentChildFile ("bpm2time-replay", {}, false);
+            dir.createDirectory();
+            setenv ("BPM2TIME_CAPTURE_DIR", dir.getFullPathName().toRawUTF8(), 1);
+            setenv ("BPM2TIME_LOG_DIR", dir.getFullPathName().toRawUTF8(), 1);
+
+            PassthroughTempoProcessor processor;
+            replayer.replay (processor);
+
+            unsetenv ("BPM2TIME_CAPTURE_DIR");
+            unsetenv ("BPM2TIME_LOG_DIR");
+
+            expect (! processor.isCapturingPlayhead() && ! processor.isTempoLogging());
+            expectEquals ((int) dir.findChildFiles (juce::File::findFiles, true).size(), 0);
+            dir.deleteRecursively();
+        }
+       #endif
+    }
+};
+
+static PlayheadTraceTests playheadTraceTests;
@@ -0,0 +1,231 @@
+#include <JuceHeader.h>
+#include "PlayheadTrace.h"
+#include "PluginProcessor.h"
+#include "TempoConditioner.h"
+#include "TestUtilities.h"
+
+namespace
+{
+    struct ConditionedRun
+    {
+        int numRawChanges = 0;
+        int numConditionedChanges = 0;
+        std::vector<double> conditioned;    // One per block
+        std::vector<double> raw;
+    };
+
+    ConditionedRun runThroughConditioner (const PlayheadTrace::Replayer& trace, const TempoConditioner::Settings& settings)
+    {
+        TempoConditioner conditioner;
+        conditioner.setSettings (settings);
+
+        ConditionedRun run;
+        double previousRaw = -1.0;
+
+        for (const auto& record : trace.getRecords())
+        {
+            auto pos = PlayheadTrace::decode (record);
+
+            if (! pos.hasValue() || ! pos->getBpm().hasValue())
+                continue;
+
+            const auto raw = *pos->getBpm();
+
+            if (raw != previousRaw && previousRaw >= 0.0)
+                ++run.numRawChanges;
+
+            previousRaw = raw;
+
+            if (conditioner.process (raw, record.numSamples / trace.getHeader().sampleRate) && ! run.conditioned.empty())
+                ++run.numConditionedChanges;
+
+            run.conditioned.push_back (conditioner.getBpm());
+            run.raw.push_back (raw);
+        }
+
+        return run;
+    }
+
+    TempoConditioner::Settings settingsWith (TempoConditioner::FilterMode mode, double deadband = 0.005, double snap = 0.0)
+    {
+        TempoConditioner::Settings settings;
+        settings.filterMode = mode;
+        settings.deadbandBpm = deadband;
+        settings.snapResolutionBpm = snap;
+        return settings;
+    }
+}
+
+class TempoConditionerTests : public juce::UnitTest
+{
+public:
+    TempoConditionerTests() : juce::UnitTest ("Tempo conditioner", "TempoConditioner") {}
+
+    void runTest() override
+    {
+        using Mode = TempoConditioner::FilterMode;
+        juce::TemporaryFile traceFile (".bptrace");
+
+        beginTest ("Float jitter from the host never reaches the output");
+        {
+            // Some hosts report 120 +/- a few millionths from block to block
+            juce::Random random (30);
+            PlayheadTrace::Replayer trace;
+            expect (trace.load (TestTrace::write (traceFile.getFile(), 5000,
+                                            [&] (int) { return 120.0 + (random.nextDouble() - 0.5) * 1.0e-5; })));
+
+            for (auto mode : { Mode::none, Mode::median, Mode::oneEuro })
+            {
+                const auto run = runThroughConditioner (trace, settingsWith (mode));
+                expectGreaterThan (run.numRawChanges, 4000);
+                expectEquals (run.numConditionedChanges, 0, "Jitter moved the conditioned tempo");
+            }
+        }
+
+        beginTest ("A drifting external clock is followed without chatter");
+        {
+            // Chasing MIDI clock: a slow random walk with per-block noise of around 0.02 BPM
+            juce::Random random (31);
+            double drift = 0.0;
+            PlayheadTrace::Replayer trace;
+            expect (trace.load (TestTrace::write (traceFile.getFile(), 20000, [&] (int)
+            {
+                drift += (random.nextDouble() - 0.5) * 0.002;
+                return 124.0 + drift + (random.nextDouble() - 0.5) * 0.04;
+            })));
+
+            const auto run = runThroughConditioner (trace, settingsWith (Mode::median, 0.05));
+            expectLessThan (run.numConditionedChanges * 20, run.numRawChanges, "The conditioned tempo changed too often");
+
+            for (size_t i = 0; i < run.raw.size(); ++i)
+                if (std::abs (run.conditioned[i] - run.raw[i]) > 0.2)
+                {
+                    expect (false, "The conditioned tempo lost track of the clock at block " + juce::String ((int) i));
+                    break;
+                }
+        }
+
+        beginTest ("Real tempo changes still get through quickly");
+        {
+            juce::Random random (32);
+            PlayheadTrace::Replayer trace;
+            expect (trace.load (TestTrace::write (traceFile.getFile(), 2000, [&] (int i)
+            {
+                return (i < 1000 ? 120.0 : 96.0) + (random.nextDouble() - 0.5) * 1.0e-5;
+            })));
+
+            for (auto mode : { Mode::none, Mode::median, Mode::oneEuro })
+            {
+                const auto run = runThroughConditioner (trace, settingsWith (mode));
+
+                // Within 20 blocks (about 200 ms) of the change, the output is within a hundredth of a BPM
+                expectWithinAbsoluteError (run.conditioned[1020], 96.0, 0.01);
+                expectWithinAbsoluteError (run.conditioned[999], 120.0, 0.01);
+            }
+        }
+
+        beginTest ("Snapping holds the output on the grid");
+        {
+            juce::Random random (33);
+            PlayheadTrace::Replayer trace;
+            expect (trace.load (TestTrace::write (traceFile.getFile(), 3000,
+                                            [&] (int) { return 99.97 + (random.nextDouble() - 0.5) * 0.02; })));
+
+            const auto run = runThroughConditioner (trace, settingsWith (Mode::median, 0.005, 0.1));
+
+            for (auto bpm : run.conditioned)
+                expectWithinAbsoluteError (bpm, 100.0, 1.0e-9);
+        }
+
+        beginTest ("Captured host traces");
+        {
+            // Drop .bptrace captures (see BPM2TIME_CAPTURE_DIR) into Tests/Traces to replay them here
+            const juce::File tracesDir (BPM2TIME_TEST_TRACES_DIR);
+            int numTraces = 0;
+
+            for (const auto& file : tracesDir.findChildFiles (juce::File::findFiles, false, "*.bptrace"))
+            {
+                PlayheadTrace::Replayer trace;
+
+                if (! trace.load (file))
+                {
+                    expect (false, "Couldn't load " + file.getFileName());
+                    continue;
+                }
+
+                ++numTraces;
+
+                for (auto mode : { Mode::none, Mode::median, Mode::oneEuro })
+                {
+                    const auto run = runThroughConditioner (trace, settingsWith (mode));
+                    expectLessOrEqual (run.numConditionedChanges, run.numRawChanges, file.getFileName());
+
+                    if (! run.raw.empty())
+                        expectWithinAbsoluteError (run.conditioned.back(), run.raw.back(), 0.5, file.getFileName());
+                }
+            }
+
+            logMessage ("Replayed " + juce::String (numTraces) + " captured traces from " + tracesDir.getFullPathName());
+        }
+
+        beginTest ("The processor takes its settings from the saved parameters");
+        {
+            FakePlayHead playHead;
+            playHead.bpm = 120.4;
+
+            juce::MemoryBlock state;
+            {
+                PassthroughTempoProcessor processor;
+                auto* snap = processor.apvts.getParameter ("tempoSnap");
+                snap->setValueNotifyingHost (snap->convertTo0to1 (3.0f));  // 1 BPM
+                processor.getStateInformation (state);
+            }
+
+            PassthroughTempoProcessor processor;
+            processor.setStateInformation (state.getData(), (int) state.getSize());
+            processor.setPlayHead (&playHead);
+            processor.setRateAndBufferSizeDetails (TestTrace::sampleRate, TestTrace::blockSize);
+            processor.prepareToPlay (TestTrace::sampleRate, TestTrace::blockSize);
+
+            juce::AudioBuffer<float> buffer (2, TestTrace::blockSize);
+            juce::MidiBuffer midi;
+
+            for (int i = 0; i < 100; ++i)
+            {
+                processor.processBlock (buffer, midi);
+                playHead.advance (TestTrace::blockSize);
+            }
+
+            expectWithinAbsoluteError (processor.getEffectiveBpm(), 120.0, 1.0e-9);
+        }
+
+        beginTest ("Forced reads go through the conditioner, even while stopped");
+        {
+            FakePlayHead playHead;
+            playHead.playing = false;
+            playHead.bpm = 87.3;
+
+            PassthroughTempoProcessor processor;
+            auto* snap = processor.apvts.getParameter ("tempoSnap");
+            snap->setValueNotifyingHost (snap->convertTo0to1 (2.0f));  // 0.1 BPM
+            playHead.bpm = 87.34;
+
+            processor.setPlayHead (&playHead);
+            processor.setRateAndBufferSizeDetails (TestTrace::sampleRate, TestTrace::blockSize);
+            processor.prepareToPlay (TestTrace::sampleRate, TestTrace::blockSize);
+
+            juce::AudioBuffer<float> buffer (2, TestTrace::blockSize);
+            juce::MidiBuffer midi;
+
+            processor.processBlock (buffer, midi);
+            expect (! processor.hostProvidedBpm(), "A stopped transport was read without being asked");
+
+            processor.forceReadBpmFromHost();
+            processor.processBlock (buffer, midi);
+            expect (processor.hostProvidedBpm());
+            expectWithinAbsoluteError (processor.getEffectiveBpm(), 87.3, 1.0e-9);
+        }
+    }
+};
+
+static TempoConditionerTests tempoConditionerTests;
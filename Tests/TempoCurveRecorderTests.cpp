@@ -0,0 +1,147 @@
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+#include "TempoCurveRecorder.h"
+#include "TestUtilities.h"
+
+class TempoCurveRecorderTests : public juce::UnitTest
+{
+public:
+    TempoCurveRecorderTests() : juce::UnitTest ("Tempo curve recorder", "TempoMap") {}
+
+    void runTest() override
+    {
+        // 512-sample blocks at 48 kHz and 120 BPM
+        constexpr double quartersPerBlock = 512.0 * 120.0 / (60.0 * 48000.0);
+
+        beginTest ("A held tempo with wobble stays one segment");
+        {
+            TempoCurveRecorder recorder;
+
+            for (int i = 0; i < 100000; ++i)
+                recorder.addSample ({ i * quartersPerBlock, 120.0 + ((i & 1) != 0 ? 0.01 : -0.01) });
+
+            expectEquals (recorder.getNumSegments(), 1);
+
+            TempoMap map;
+            recorder.fillTempoMap (map);
+            expectWithinAbsoluteError (map.getBpmAt (1000.0, 0.0), 120.0, TempoCurveRecorder::holdToleranceBpm);
+        }
+
+        beginTest ("Tempo that never settles is capped");
+        {
+            TempoCurveRecorder recorder;
+            juce::Random random (29);
+
+            for (int i = 0; i < 100000; ++i)
+                recorder.addSample ({ i * quartersPerBlock, 60.0 + 120.0 * random.nextDouble() });
+
+            expectLessOrEqual (recorder.getNumSegments(), (int) TempoCurveRecorder::maxSegments);
+        }
+
+        beginTest ("A ramp matches the analytic duration");
+        {
+            // 100 to 140 BPM over 16 quarters, then held
+            TempoCurveRecorder recorder;
+            auto bpmAt = [] (double ppq) { return ppq < 16.0 ? 100.0 + 2.5 * ppq : 140.0; };
+
+            for (double ppq = 0.0; ppq < 32.0; ppq += quartersPerBlock)
+                recorder.addSample ({ ppq, bpmAt (ppq) });
+
+            TempoMap map;
+            recorder.fillTempoMap (map);
+            expectLessThan (map.getNumSegments(), 5);
+
+            // The integral of 60000 / (100 + 2.5 ppq) over the ramp, plus 16 quarters at 140
+            const double expectedMs = (60000.0 / 2.5) * std::log (140.0 / 100.0) + 16.0 * 60000.0 / 140.0;
+            expectWithinAbsoluteError (map.getDurationMs (0.0, 32.0), expectedMs, expectedMs * 1.0e-3);
+        }
+
+        beginTest ("Steps are kept");
+        {
+            TempoCurveRecorder recorder;
+
+            for (int i = 0; i < 2000; ++i)
+                recorder.addSample ({ i * quartersPerBlock, i < 1000 ? 120.0 : 90.0 });
+
+            TempoMap map;
+            recorder.fillTempoMap (map);
+            expectWithinAbsoluteError (map.getBpmAt (10.0, 0.0), 120.0, 1.0e-9);
+            expectWithinAbsoluteError (map.getBpmAt (30.0, 0.0), 90.0, 1.0e-9);
+            expectLessThan (map.getNumSegments(), 4);
+        }
+
+        beginTest ("The processor records the conditioned tempo, not the host's jitter");
+        {
+            FakePlayHead playHead;
+            PassthroughTempoProcessor processor;
+            processor.setPlayHead (&playHead);
+            processor.setRateAndBufferSizeDetails (48000.0, 512);
+            processor.prepareToPlay (48000.0, 512);
+
+            juce::AudioBuffer<float> buffer (2, 512);
+            juce::MidiBuffer midi;
+
+            for (int i = 0; i < 20000; ++i)
+            {
+                playHead.bpm = 120.0 + ((i & 1) != 0 ? 0.01 : -0.01);
+                processor.processBlock (buffer, midi);
+                playHead.advance (512);
+
+                // Roughly how often an open editor drains the queue
+                if (i % 50 == 0)
+                    processor.processQueuedAnalysis();
+            }
+
+            processor.processQueuedAnalysis();
+            expectEquals (processor.getTempoMap().getNumSegments(), 1);
+        }
+
+        beginTest ("A whole note in the middle of a ramp shows its length along the ramp");
+        {
+            // 100 BPM for a bar, a ramp up 2.5 BPM per quarter to 140 BPM, and back down the
+            // same way. It's looped, so the second pass through the ramp plays over the curve
+            // recorded on the first.
+            const auto bpmAt = [] (double ppq)
+            {
+                return juce::jlimit (100.0, 140.0, juce::jmin (100.0 + 2.5 * (ppq - 4.0), 140.0 - 2.5 * (ppq - 24.0)));
+            };
+
+            FakePlayHead playHead;
+            playHead.looping = true;
+            playHead.loopStartPpq = 0.0;
+            playHead.loopEndPpq = 48.0;
+
+            PassthroughTempoProcessor processor;
+            processor.setDivisionIndexNotifyingHost (7);    // 1/1
+            processor.setPlayHead (&playHead);
+            processor.setRateAndBufferSizeDetails (48000.0, 512);
+            processor.prepareToPlay (48000.0, 512);
+
+            juce::AudioBuffer<float> buffer (2, 512);
+            juce::MidiBuffer midi;
+            bool secondPass = false;
+
+            // Until a quarter way into the ramp on the second pass
+            while (! (secondPass && playHead.ppq >= 10.0))
+            {
+                playHead.bpm = bpmAt (playHead.ppq);
+                processor.processBlock (buffer, midi);
+
+                const auto before = playHead.ppq;
+                playHead.advance (512);
+                secondPass = secondPass || playHead.ppq < before;
+                processor.processQueuedAnalysis();
+            }
+
+            const auto ppq = processor.getLastPpqPosition();
+            const auto rampMs = 60000.0 / 2.5 * std::log (bpmAt (ppq + 4.0) / bpmAt (ppq));
+            const auto constantMs = 4.0 * 60000.0 / processor.getCachedBpm();
+
+            // The cached tempo trails the ramp, so the two must be well apart for this to mean anything
+            expectGreaterThan (std::abs (constantMs - rampMs), 0.02 * rampMs);
+            expectWithinAbsoluteError (processor.getCurrentDivisionMs(), rampMs, 0.002 * rampMs);
+        }
+    }
+};
+
+static TempoCurveRecorderTests tempoCurveRecorderTests;
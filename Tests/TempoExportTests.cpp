@@ -0,0 +1,161 @@
+// Tests for the standalone tempo export header. Like the header, this needs nothing
+// but the standard library and POSIX, so it's built even without JUCE.
+
+#include "TempoExport.h"
+
+#include <cstdio>
+#include <string>
+#include <sys/wait.h>
+
+namespace
+{
+    int numFailures = 0;
+
+    void expect (bool condition, const char* description)
+    {
+        if (! condition)
+        {
+            std::printf ("FAILED: %s\n", description);
+            ++numFailures;
+        }
+    }
+
+    /** Zero-filled shared mapping, just like a segment shm_open has just created. */
+    struct MappedSegment
+    {
+        MappedSegment()
+        {
+            void* mapped = ::mmap (nullptr, sizeof (TempoExport::Segment), PROT_READ | PROT_WRITE,
+                                   MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+            segment = mapped != MAP_FAILED ? static_cast<TempoExport::Segment*> (mapped) : nullptr;
+        }
+
+        ~MappedSegment()
+        {
+            if (segment != nullptr)
+                ::munmap (segment, sizeof (TempoExport::Segment));
+        }
+
+        TempoExport::Segment* segment;
+    };
+
+    int32_t pidOfExitedProcess()
+    {
+        const pid_t child = ::fork();
+
+        if (child == 0)
+            ::_exit (0);
+
+        ::waitpid (child, nullptr, 0);
+        return (int32_t) child;
+    }
+
+    void testClaiming()
+    {
+        MappedSegment mapped;
+        auto& segment = *mapped.segment;
+        const auto self = (int32_t) ::getpid();
+
+        expect (TempoExport::claimSegment (segment, self), "A segment nobody owns can be claimed");
+        expect (TempoExport::claimSegment (segment, self), "Claiming a segment we already own succeeds");
+
+        // Our parent (the test runner or shell) is certainly still alive
+        segment.ownerPid.store ((int32_t) ::getppid());
+        expect (! TempoExport::claimSegment (segment, self), "A segment owned by a live process can't be claimed");
+
+        TempoExport::releaseSegment (segment, self);
+        expect (segment.ownerPid.load() == (int32_t) ::getppid(), "Releasing someone else's segment does nothing");
+
+        segment.ownerPid.store (pidOfExitedProcess());
+        expect (TempoExport::claimSegment (segment, self), "A segment whose owner died can be taken over");
+
+        TempoExport::releaseSegment (segment, self);
+        expect (segment.ownerPid.load() == 0, "Releasing our own segment leaves it unowned");
+    }
+
+    void testSeqlock()
+    {
+        MappedSegment mapped;
+        auto& segment = *mapped.segment;
+
+        TempoExport::Snapshot written;
+        written.bpm = 123.5;
+        written.ppqPosition = 17.25;
+        written.timeSigNumerator = 7;
+        written.timeSigDenominator = 8;
+        written.isPlaying = 1;
+        TempoExport::writeSnapshot (segment, written);
+
+        TempoExport::Snapshot read;
+        expect (TempoExport::readSnapshot (segment, read), "A settled snapshot can be read");
+        expect (read.bpm == 123.5 && read.ppqPosition == 17.25, "The snapshot reads back unchanged");
+        expect (read.timeSigNumerator == 7 && read.timeSigDenominator == 8 && read.isPlaying == 1,
+                "The snapshot's time signature and transport read back unchanged");
+        expect (segment.sequence.load() == 2, "Each write moves the sequence on by two");
+
+        segment.sequence.store (3);
+        expect (! TempoExport::readSnapshot (segment, read), "A snapshot that's mid-write isn't read");
+    }
+
+    void testReader()
+    {
+        const auto name = "/bpm2time.test." + std::to_string (::getpid());
+        const int fd = ::shm_open (name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        expect (fd >= 0, "A private test segment can be created");
+
+        if (fd < 0)
+            return;
+
+        // What a reader sees between the writer's shm_open and its ftruncate
+        {
+            TempoExport::Reader reader;
+            expect (! reader.open (name.c_str()), "A segment that hasn't been sized yet isn't accepted");
+        }
+
+        const bool sized = ::ftruncate (fd, (off_t) sizeof (TempoExport::Segment)) == 0;
+        void* mapped = sized ? ::mmap (nullptr, sizeof (TempoExport::Segment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)
+                             : MAP_FAILED;
+        ::close (fd);
+        expect (mapped != MAP_FAILED, "The test segment can be mapped");
+
+        if (mapped != MAP_FAILED)
+        {
+            auto& segment = *static_cast<TempoExport::Segment*> (mapped);
+
+            TempoExport::Reader reader;
+            expect (! reader.open (name.c_str()), "A segment nobody has published to isn't accepted");
+
+            segment.version = TempoExport::version;
+            segment.snapshotSize = (uint32_t) sizeof (TempoExport::Snapshot);
+            TempoExport::Snapshot written;
+            written.bpm = 98.0;
+            TempoExport::writeSnapshot (segment, written);
+            segment.magic = TempoExport::magic;
+
+            TempoExport::Snapshot read;
+            expect (reader.open (name.c_str()) && reader.read (read) && read.bpm == 98.0,
+                    "A published segment can be opened and read");
+
+            // What a writer does when it stops publishing
+            segment.magic = 0;
+            expect (! reader.read (read), "A reader that's already open stops reading when the writer stops publishing");
+            expect (! reader.open (name.c_str()), "A segment nobody is publishing to isn't accepted");
+
+            ::munmap (mapped, sizeof (TempoExport::Segment));
+        }
+
+        ::shm_unlink (name.c_str());
+    }
+}
+
+int main()
+{
+    testClaiming();
+    testSeqlock();
+    testReader();
+
+    if (numFailures == 0)
+        std::printf ("All tempo export tests passed\n");
+
+    return numFailures > 0 ? 1 : 0;
+}
@@ -0,0 +1,127 @@
+#include <JuceHeader.h>
+#include "TempoLog.h"
+
+#include <thread>
+
+#if ! JUCE_WINDOWS
+ #include <unistd.h>
+#endif
+
+class TempoLogTests : public juce::UnitTest
+{
+public:
+    TempoLogTests() : juce::UnitTest ("Tempo log", "TempoLog") {}
+
+    void runTest() override
+    {
+        auto dir = juce::File::getSpecialLocation (juce::File::tempDirectory).getNonexistentChildFile ("bpm2time-log", {}, false);
+
+        beginTest ("Each process and instance logs to its own file");
+        {
+            TempoLog first, second;
+            expect (first.start (dir, 48000.0));
+            expect (second.start (dir, 48000.0));
+
+            TempoLogFormat::Record record;
+            record.event = (uint16_t) TempoLogFormat::Event::prepared;
+            first.push (record);
+            second.push (record);
+
+            first.stop();
+            second.stop();
+
+            const auto files = dir.findChildFiles (juce::File::findFiles, false, "*.bplog");
+            expectEquals ((int) files.size(), 2);
+
+           #if ! JUCE_WINDOWS
+            for (const auto& file : files)
+                expect (file.getFileName().startsWith ("bpm2time-" + juce::String ((int) getpid()) + "-"),
+                        file.getFileName() + " doesn't name the process");
+           #endif
+
+            for (const auto& file : files)
+                expectEquals (file.getSize(), (juce::int64) (sizeof (TempoLogFormat::FileHeader) + sizeof (TempoLogFormat::Record)));
+        }
+
+        beginTest ("Turning a log off and on again keeps what it recorded");
+        {
+            auto restartDir = dir.getChildFile ("restart");
+            TempoLog log;
+
+            for (int session = 0; session < 2; ++session)
+            {
+                expect (log.start (restartDir, 48000.0));
+                log.push ({});
+                log.stop();
+            }
+
+            const auto files = restartDir.findChildFiles (juce::File::findFiles, false, "*.bplog");
+            expectEquals ((int) files.size(), 2);
+
+            for (const auto& file : files)
+                expectEquals (file.getSize(), (juce::int64) (sizeof (TempoLogFormat::FileHeader) + sizeof (TempoLogFormat::Record)));
+        }
+
+        beginTest ("Restarting a log while the audio thread pushes to it");
+        {
+            // start() resets the ring, which mustn't happen under a push() in progress
+            TempoLog log;
+            std::atomic<bool> finished { false };
+
+            std::thread audioThread ([&]
+            {
+                while (! finished.load())
+                    log.push ({});
+            });
+
+            for (int i = 0; i < 50; ++i)
+            {
+                expect (log.start (dir.getChildFile ("busy"), 48000.0));
+                log.stop();
+            }
+
+            finished = true;
+            audioThread.join();
+        }
+
+        beginTest ("The diagnostics thread only runs while something is logging");
+        {
+            TempoLog idle;
+            expect (! isDiagnosticsThreadRunning(), "A log that was never started holds the thread");
+
+            TempoLog log;
+            expect (log.start (dir, 48000.0));
+            expect (isDiagnosticsThreadRunning());
+
+            log.stop();
+            expect (! isDiagnosticsThreadRunning(), "A stopped log still holds the thread");
+        }
+
+        beginTest ("Destroying a log while it's writing");
+        {
+            // The writer thread must be finished with the log before any of it is destroyed
+            for (int i = 0; i < 50; ++i)
+            {
+                auto log = std::make_unique<TempoLog>();
+                expect (log->start (dir, 48000.0));
+
+                for (int j = 0; j < 4000; ++j)
+                    log->push ({});
+
+                log.reset();
+            }
+        }
+
+        dir.deleteRecursively();
+    }
+
+private:
+    static bool isDiagnosticsThreadRunning()
+    {
+        // Our own reference is the only one unless a writer holds the thread too
+        juce::SharedResourcePointer<DiagnosticsThread> probe;
+        return probe.getReferenceCount() > 1;
+    }
+};
+
+static TempoLogTests tempoLogTests;
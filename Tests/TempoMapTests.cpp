@@ -0,0 +1,129 @@
+#include <JuceHeader.h>
+#include "TempoMap.h"
+
+namespace
+{
+    /** Stands in for an ARA host: describes a song's timeline the way a host hands it to
+        an ARA plug-in, as tempo entries in seconds and quarters plus bar signatures.
+    */
+    struct StandInAraHost
+    {
+        struct Section
+        {
+            int bars;
+            double bpm;
+            int numerator = 4;
+            int denominator = 4;
+        };
+
+        std::vector<Section> sections;
+
+        void describeTimeline (std::vector<TempoMap::HostTempoEntry>& tempoEntries,
+                               std::vector<TempoMap::HostBarSignature>& barSignatures) const
+        {
+            double seconds = 0.0, quarters = 0.0;
+
+            for (const auto& section : sections)
+            {
+                tempoEntries.push_back ({ seconds, quarters });
+                barSignatures.push_back ({ quarters, section.numerator, section.denominator });
+
+                const auto sectionQuarters = section.bars * section.numerator * 4.0 / section.denominator;
+                quarters += sectionQuarters;
+                seconds += sectionQuarters * 60.0 / section.bpm;
+            }
+
+            // Hosts close the last tempo interval with one more entry
+            tempoEntries.push_back ({ seconds, quarters });
+        }
+
+        TempoMap buildMap() const
+        {
+            std::vector<TempoMap::HostTempoEntry> tempoEntries;
+            std::vector<TempoMap::HostBarSignature> barSignatures;
+            describeTimeline (tempoEntries, barSignatures);
+            return TempoMap::fromHostTimeline (tempoEntries, barSignatures);
+        }
+    };
+}
+
+class TempoMapTests : public juce::UnitTest
+{
+public:
+    TempoMapTests() : juce::UnitTest ("Tempo map", "TempoMap") {}
+
+    void runTest() override
+    {
+        beginTest ("Constant tempo from the host");
+        {
+            const auto map = StandInAraHost { { { 16, 120.0 } } }.buildMap();
+
+            expectEquals (map.getNumSegments(), 1);
+            expectWithinAbsoluteError (map.getBpmAt (10.0, 0.0), 120.0, 1.0e-9);
+            expectWithinAbsoluteError (map.getSecondsAt (64.0), 32.0, 1.0e-9);
+            expectWithinAbsoluteError (map.getBarsBetween (0.0, 64.0), 16.0, 1.0e-9);
+        }
+
+        beginTest ("Tempo changes land where the host put them");
+        {
+            const StandInAraHost host { { { 8, 120.0 }, { 4, 90.0 }, { 8, 140.0 } } };
+            const auto map = host.buildMap();
+
+            std::vector<TempoMap::HostTempoEntry> entries;
+            std::vector<TempoMap::HostBarSignature> signatures;
+            host.describeTimeline (entries, signatures);
+
+            for (const auto& entry : entries)
+                expectWithinAbsoluteError (map.getSecondsAt (entry.quarters), entry.seconds, 1.0e-9,
+                                           "Wall-clock time at a host tempo entry");
+
+            expectWithinAbsoluteError (map.getBpmAt (31.9, 0.0), 120.0, 1.0e-9);
+            expectWithinAbsoluteError (map.getBpmAt (32.0, 0.0), 90.0, 1.0e-9);
+            expectWithinAbsoluteError (map.getBpmAt (60.0, 0.0), 140.0, 1.0e-9);
+
+            auto* next = map.getNextChangeAfter (0.0);
+            expect (next != nullptr && std::abs (next->startPpq - 32.0) < 1.0e-9 && std::abs (next->bpm - 90.0) < 1.0e-9);
+        }
+
+        beginTest ("Metre changes split the map and count bars in their own metre");
+        {
+            // 4 bars of 4/4, then 6 bars of 7/8 (3.5 quarters each), then 3 bars of 6/8
+            const auto map = StandInAraHost { { { 4, 100.0 }, { 6, 100.0, 7, 8 }, { 3, 100.0, 6, 8 } } }.buildMap();
+
+            auto* sevenEight = map.getSegmentAt (16.0);
+            expect (sevenEight != nullptr && sevenEight->timeSigNumerator == 7 && sevenEight->timeSigDenominator == 8);
+
+            auto* next = map.getNextChangeAfter (16.0);
+            expect (next != nullptr && std::abs (next->startPpq - 37.0) < 1.0e-9 && next->timeSigNumerator == 6);
+
+            expectWithinAbsoluteError (map.getBarsBetween (0.0, 16.0), 4.0, 1.0e-9);
+            expectWithinAbsoluteError (map.getBarsBetween (16.0, 37.0), 6.0, 1.0e-9);
+            expectWithinAbsoluteError (map.getBarsBetween (20.0, 37.0), 17.0 / 3.5, 1.0e-9);
+            expectWithinAbsoluteError (map.getBarsBetween (0.0, 46.0), 13.0, 1.0e-9);
+
+            // The tempo is the same throughout, so only the metre change is a change
+            expectWithinAbsoluteError (map.getBpmAt (40.0, 0.0), 100.0, 1.0e-9);
+        }
+
+        beginTest ("A host edit replaces the whole map");
+        {
+            StandInAraHost host { { { 8, 120.0 }, { 8, 120.0, 3, 4 } } };
+            auto map = host.buildMap();
+            expectEquals (map.getSegmentAt (40.0)->timeSigNumerator, 3);
+
+            host.sections[1] = { 8, 150.0, 5, 4 };
+            map = host.buildMap();
+            expectEquals (map.getSegmentAt (40.0)->timeSigNumerator, 5);
+            expectWithinAbsoluteError (map.getBpmAt (40.0, 0.0), 150.0, 1.0e-9);
+        }
+
+        beginTest ("A timeline too short to describe a tempo gives an empty map");
+        {
+            expect (TempoMap::fromHostTimeline ({ { 0.0, 0.0 } }, { { 0.0, 4, 4 } }).isEmpty());
+            expect (TempoMap::fromHostTimeline ({}, {}).isEmpty());
+            expectWithinAbsoluteError (TempoMap().getBarsBetween (0.0, 8.0), 2.0, 1.0e-9);
+        }
+    }
+};
+
+static TempoMapTests tempoMapTests;
@@ -0,0 +1,66 @@
+// Runs the BPM2Time unit tests, or with --benchmarks the benchmarks.
+//
+//   BPM2TimeTests [--category <name>]
+//   BPM2TimeTests --benchmarks [--threshold-scale <x>] [--max-instances <n>] [--plugin <binary>]
+//
+// Exits with a non-zero status if anything failed.
+
+#include <JuceHeader.h>
+#include "TestUtilities.h"
+
+namespace
+{
+    constexpr const char* benchmarkCategory = "Benchmarks";
+
+    void parseOptions (const juce::ArgumentList& args)
+    {
+        auto& options = TestOptions::get();
+        options.runBenchmarks = args.containsOption ("--benchmarks");
+        options.category = args.getValueForOption ("--category");
+
+        if (auto plugin = args.getValueForOption ("--plugin"); plugin.isNotEmpty())
+            options.pluginBinary = juce::File::getCurrentWorkingDirectory().getChildFile (plugin);
+
+        if (auto n = args.getValueForOption ("--max-instances"); n.isNotEmpty())
+            options.maxInstances = juce::jmax (1, n.getIntValue());
+
+        if (auto scale = args.getValueForOption ("--threshold-scale"); scale.isNotEmpty())
+            options.thresholdScale = juce::jmax (0.01, scale.getDoubleValue());
+    }
+
+    juce::Array<juce::UnitTest*> getTestsToRun()
+    {
+        const auto& options = TestOptions::get();
+        juce::Array<juce::UnitTest*> tests;
+
+        for (auto* test : juce::UnitTest::getAllTests())
+        {
+            const bool isBenchmark = test->getCategory() == benchmarkCategory;
+
+            if (options.category.isNotEmpty() ? test->getCategory() == options.category
+                                              : isBenchmark == options.runBenchmarks)
+                tests.add (test);
+        }
+
+        return tests;
+    }
+}
+
+int main (int argc, char* argv[])
+{
+    // Editors, timers and SharedResourcePointers all expect a message manager to exist
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    parseOptions ({ argc, argv });
+
+    juce::UnitTestRunner runner;
+    runner.setAssertOnFailure (false);
+    runner.runTests (getTestsToRun());
+
+    int numFailures = 0;
+
+    for (int i = 0; i < runner.getNumResults(); ++i)
+        numFailures += runner.getResult (i)->failures;
+
+    return numFailures > 0 ? 1 : 0;
+}
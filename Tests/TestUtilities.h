@@ -0,0 +1,196 @@
+#pragma once
+#include <JuceHeader.h>
+#include "PlayheadTrace.h"
+
+#if JUCE_MAC
+ #include <mach/mach.h>
+#elif JUCE_LINUX || JUCE_BSD
+ #include <unistd.h>
+#endif
+
+/** Command-line settings shared by every test and benchmark. Filled in by main(). */
+struct TestOptions
+{
+    bool runBenchmarks = false;
+    juce::String category;
+    juce::File pluginBinary;        // Optional: a built plugin binary to time a cold load of
+    int maxInstances = 1000;
+    double thresholdScale = 1.0;    // Loosens every benchmark threshold on slower machines
+
+    static TestOptions& get()
+    {
+        static TestOptions options;
+        return options;
+    }
+
+    /** A benchmark limit, scaled for the machine the benchmark is running on. */
+    static double threshold (double value) { return value * get().thresholdScale; }
+};
+
+//==============================================================================
+/** A transport that runs by itself, standing in for a host's playhead.
+
+    Each call to advance() moves it on by one block at the current tempo, the way a host
+    moves its playhead between processBlock calls. With looping on, it jumps back by the
+    loop's length whenever it reaches the loop end.
+*/
+class FakePlayHead : public juce::AudioPlayHead
+{
+public:
+    double sampleRate = 48000.0;
+    double bpm = 120.0;
+    double ppq = 0.0;
+    int64_t timeInSamples = 0;
+    int numerator = 4;
+    int denominator = 4;
+    bool playing = true;
+    bool provideBpm = true;
+    bool looping = false;
+    double loopStartPpq = 0.0;
+    double loopEndPpq = 0.0;
+
+    juce::Optional<PositionInfo> getPosition() const override
+    {
+        PositionInfo pos;
+        pos.setIsPlaying (playing);
+        pos.setPpqPosition (ppq);
+        pos.setTimeInSamples (timeInSamples);
+        pos.setTimeInSeconds ((double) timeInSamples / sampleRate);
+        pos.setTimeSignature (TimeSignature { numerator, denominator });
+
+        const double barQuarters = numerator * 4.0 / denominator;
+        pos.setPpqPositionOfLastBarStart (std::floor (ppq / barQuarters) * barQuarters);
+
+        if (provideBpm)
+            pos.setBpm (bpm);
+
+        if (looping)
+        {
+            pos.setIsLooping (true);
+            pos.setLoopPoints (LoopPoints { loopStartPpq, loopEndPpq });
+        }
+
+        return pos;
+    }
+
+    void advance (int numSamples)
+    {
+        if (! playing)
+            return;
+
+        ppq += numSamples * bpm / (60.0 * sampleRate);
+        timeInSamples += numSamples;
+
+        if (looping && loopEndPpq > loopStartPpq && ppq >= loopEndPpq)
+            ppq -= loopEndPpq - loopStartPpq;
+    }
+};
+
+//==============================================================================
+/** Synthetic playhead traces, in the same format as the ones captured from hosts. */
+namespace TestTrace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 512;
+
+    /** Writes a trace of a playing transport whose reported tempo is bpmForBlock(i). */
+    template <typename BpmForBlock>
+    juce::File write (const juce::File& file, int numBlocks, BpmForBlock&& bpmForBlock)
+    {
+        PlayheadTrace::FileHeader header;
+        header.sampleRate = sampleRate;
+        header.maxBlockSize = blockSize;
+        header.numChannels = 2;
+
+        juce::MemoryBlock data (&header, sizeof (header));
+        double ppq = 0.0;
+
+        for (int i = 0; i < numBlocks; ++i)
+        {
+            const double bpm = bpmForBlock (i);
+
+            juce::AudioPlayHead::PositionInfo pos;
+            pos.setIsPlaying (true);
+            pos.setBpm (bpm);
+            pos.setPpqPosition (ppq);
+            pos.setTimeInSamples ((int64_t) i * blockSize);
+
+            const auto record = PlayheadTrace::encode (pos, blockSize);
+            data.append (&record, sizeof (record));
+            ppq += blockSize * bpm / (60.0 * sampleRate);
+        }
+
+        file.replaceWithData (data.getData(), data.getSize());
+        return file;
+    }
+}
+
+//==============================================================================
+namespace Benchmark
+{
+    inline double nowMicroseconds() noexcept
+    {
+        return juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks()) * 1.0e6;
+    }
+
+    /** Resident memory of this process, or 0 where we don't know how to measure it. */
+    inline size_t getResidentBytes()
+    {
+       #if JUCE_MAC
+        mach_task_basic_info info {};
+        mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+
+        if (task_info (mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t) &info, &count) == KERN_SUCCESS)
+            return (size_t) info.resident_size;
+       #elif JUCE_LINUX || JUCE_BSD
+        juce::StringArray fields;
+        fields.addTokens (juce::File ("/proc/self/statm").loadFileAsString(), " ", {});
+
+        if (fields.size() > 1)
+            return (size_t) fields[1].getLargeIntValue() * (size_t) sysconf (_SC_PAGESIZE);
+       #endif
+
+        return 0;
+    }
+
+    /** Collects timings and reports them the same way in every benchmark. */
+    struct Stats
+    {
+        void add (double value) { values.push_back (value); }
+
+        double mean() const
+        {
+            return values.empty() ? 0.0 : std::accumulate (values.begin(), values.end(), 0.0) / (double) values.size();
+        }
+
+        double percentile (double p) const
+        {
+            if (values.empty())
+                return 0.0;
+
+            auto sorted = values;
+            std::sort (sorted.begin(), sorted.end());
+            const auto index = juce::jlimit ((size_t) 0, sorted.size() - 1, (size_t) (p * (double) (sorted.size() - 1) + 0.5));
+            return sorted[index];
+        }
+
+        double max() const { return values.empty() ? 0.0 : *std::max_element (values.begin(), values.end()); }
+
+        juce::String describe (const juce::String& unit) const
+        {
+            return "mean " + juce::String (mean(), 2) + " " + unit
+                 + ", p99 " + juce::String (percentile (0.99), 2) + " " + unit
+                 + ", max " + juce::String (max(), 2) + " " + unit;
+        }
+
+        std::vector<double> values;
+    };
+
+    inline juce::String describeBytes (double bytes)
+    {
+        if (std::abs (bytes) >= 1024.0 * 1024.0)
+            return juce::String (bytes / (1024.0 * 1024.0), 2) + " MB";
+
+        return juce::String (bytes / 1024.0, 1) + " KB";
+    }
+}
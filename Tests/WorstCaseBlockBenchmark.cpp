@@ -0,0 +1,122 @@
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+#include "TestUtilities.h"
+
+/** What one block costs with everything switched on at once: sync following a tempo that
+    changes every block, the clock outputs at their finest division with a loop wrapping
+    through them, groove analysis fed a transient as often as it will take one, and the
+    tempo log and playhead capture both recording.
+
+    The host has to finish every block in time, so the slowest blocks matter as much as
+    the mean; each is reported as a share of the block's real-time duration.
+*/
+class WorstCaseBlockBenchmark : public juce::UnitTest
+{
+public:
+    WorstCaseBlockBenchmark() : juce::UnitTest ("Worst-case block", "Benchmarks") {}
+
+    void runTest() override
+    {
+        for (int blockSize : { 32, 512, 4096 })
+        {
+            beginTest (juce::String (blockSize) + "-sample blocks");
+            measure (blockSize);
+        }
+    }
+
+private:
+    static constexpr double sampleRate = 48000.0;
+    static constexpr double secondsToTime = 20.0;
+
+    // Shares of each block's real-time duration
+    static constexpr double maxMeanRealTimePercent = 2.0;
+    static constexpr double maxP99RealTimePercent = 10.0;
+
+    void measure (int blockSize)
+    {
+        auto dir = juce::File::getSpecialLocation (juce::File::tempDirectory).getNonexistentChildFile ("bpm2time-worst-case", {}, false);
+        dir.createDirectory();
+
+        FakePlayHead playHead;
+        playHead.sampleRate = sampleRate;
+        playHead.looping = true;
+        playHead.loopStartPpq = 4.0;
+        playHead.loopEndPpq = 7.9;
+        playHead.ppq = 4.0;
+
+        PassthroughTempoProcessor processor;
+
+        if (auto* clockBus = processor.getBus (false, 1))
+            clockBus->enable (true);
+
+        if (auto* groove = processor.apvts.getParameter ("grooveAnalysis"))
+            groove->setValueNotifyingHost (1.0f);
+
+        processor.setDivisionIndexNotifyingHost (0);    // 1/128, the most clock pulses
+        processor.setPlayHead (&playHead);
+        processor.setRateAndBufferSizeDetails (sampleRate, blockSize);
+        processor.prepareToPlay (sampleRate, blockSize);
+
+        expect (processor.startTempoLog (dir));
+        expect (processor.startPlayheadCapture (dir.getChildFile ("playhead.bptrace")));
+
+        const int numChannels = juce::jmax (processor.getTotalNumInputChannels(), processor.getTotalNumOutputChannels());
+        juce::AudioBuffer<float> buffer (numChannels, blockSize);
+        juce::MidiBuffer midi;
+        juce::Random random (1234);
+
+        // A short burst just after the groove analyser re-arms, alternating sides
+        const int burstInterval = (int) (0.07 * sampleRate);
+        const int burstLength = GrooveAnalyser::hopSize;
+        int64_t sample = 0;
+
+        const int numBlocks = (int) (secondsToTime * sampleRate / blockSize);
+        Benchmark::Stats blockMicroseconds;
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            // Ramping with jitter on top, so the conditioner and the tempo log see a change every block
+            playHead.bpm = 120.0 + 30.0 * std::sin (block * blockSize / sampleRate) + (random.nextDouble() - 0.5) * 0.2;
+
+            buffer.clear();
+
+            for (int i = 0; i < blockSize; ++i)
+            {
+                const auto sinceBurst = (sample + i) % burstInterval;
+
+                if (sinceBurst < burstLength)
+                    buffer.setSample ((int) (((sample + i) / burstInterval) % 2), i, random.nextFloat() * 2.0f - 1.0f);
+            }
+
+            const auto start = Benchmark::nowMicroseconds();
+            processor.processBlock (buffer, midi);
+            blockMicroseconds.add (Benchmark::nowMicroseconds() - start);
+
+            processor.processQueuedAnalysis();
+            playHead.advance (blockSize);
+            sample += blockSize;
+        }
+
+        // Make sure the bursts were taken as hits, or the groove analyser's slowest path wasn't timed
+        expectGreaterThan (processor.getGrooveHistogram().getNumHits(), 0, "No groove hits were found");
+
+        processor.stopTempoLog();
+        processor.stopPlayheadCapture();
+        processor.releaseResources();
+        dir.deleteRecursively();
+
+        const auto blockDurationMicroseconds = blockSize * 1.0e6 / sampleRate;
+        const auto meanPercent = 100.0 * blockMicroseconds.mean() / blockDurationMicroseconds;
+        const auto p99Percent = 100.0 * blockMicroseconds.percentile (0.99) / blockDurationMicroseconds;
+        const auto maxPercent = 100.0 * blockMicroseconds.max() / blockDurationMicroseconds;
+
+        logMessage ("Per block: " + blockMicroseconds.describe ("us"));
+        logMessage ("Of real time: mean " + juce::String (meanPercent, 3) + "%, p99 " + juce::String (p99Percent, 3)
+                    + "%, max " + juce::String (maxPercent, 3) + "%");
+
+        expectLessThan (meanPercent, TestOptions::threshold (maxMeanRealTimePercent), "Blocks take too long on average");
+        expectLessThan (p99Percent, TestOptions::threshold (maxP99RealTimePercent), "The slowest blocks take too long");
+    }
+};
+
+static WorstCaseBlockBenchmark worstCaseBlockBenchmark;
@@ -0,0 +1,98 @@
+// Decodes BPM2Time tempo diagnostics logs (.bplog) into tab-separated text.
+//
+// Build:  c++ -std=c++17 -I Source Tools/TempoLogDecoder.cpp -o bplog-decode
+// Usage:  bplog-decode bpm2time-<pid>-<launch time>-<instance>.bplog [more files...]
+
+#include "TempoLogFormat.h"
+
+#include <cstdio>
+#include <string>
+
+namespace
+{
+    std::string describeFlags (uint16_t flags)
+    {
+        static const std::pair<uint16_t, const char*> names[] = {
+            { TempoLogFormat::transportChanged, "transportChanged" },
+            { TempoLogFormat::ppqMoved,         "ppqMoved" },
+            { TempoLogFormat::bpmChanged,       "bpmChanged" },
+            { TempoLogFormat::cachedBpmUpdated, "cachedBpmUpdated" },
+            { TempoLogFormat::isPlaying,        "playing" },
+            { TempoLogFormat::syncEnabled,      "sync" },
+            { TempoLogFormat::hostBpmMissing,   "noHostBpm" },
+            { TempoLogFormat::hostPpqMissing,   "noHostPpq" },
+            { TempoLogFormat::forcedCheck,      "forced" }
+        };
+
+        std::string result;
+
+        for (const auto& [bit, name] : names)
+        {
+            if ((flags & bit) == 0)
+                continue;
+
+            if (! result.empty())
+                result += ',';
+
+            result += name;
+        }
+
+        return result.empty() ? "-" : result;
+    }
+
+    bool decodeFile (const char* path)
+    {
+        std::FILE* file = std::fopen (path, "rb");
+
+        if (file == nullptr)
+        {
+            std::fprintf (stderr, "%s: can't open\n", path);
+            return false;
+        }
+
+        TempoLogFormat::FileHeader header;
+
+        if (std::fread (&header, sizeof (header), 1, file) != 1
+            || header.magic != TempoLogFormat::magic
+            || header.version != TempoLogFormat::version
+            || header.recordSize != sizeof (TempoLogFormat::Record))
+        {
+            std::fprintf (stderr, "%s: not a BPM2Time tempo log, or from a different version\n", path);
+            std::fclose (file);
+            return false;
+        }
+
+        std::printf ("# %s  instance %u  %.0f Hz\n", path, header.instanceId, header.sampleRate);
+        std::printf ("# sample\twallMs\tevent\tblock\thostBpm\tconditionedBpm\tcachedBpm\tppq\tflags\n");
+
+        TempoLogFormat::Record r;
+
+        while (std::fread (&r, sizeof (r), 1, file) == 1)
+        {
+            std::printf ("%llu\t%.3f\t%s\t%u\t%.6f\t%.6f\t%.6f\t%.6f\t%s\n",
+                         (unsigned long long) r.sampleCount, r.wallClockMs,
+                         TempoLogFormat::getEventName (r.event), r.blockSize,
+                         r.hostBpm, r.conditionedBpm, r.cachedBpm, r.ppqPosition,
+                         describeFlags (r.flags).c_str());
+        }
+
+        std::fclose (file);
+        return true;
+    }
+}
+
+int main (int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        std::fprintf (stderr, "usage: %s file.bplog [...]\n", argv[0]);
+        return 1;
+    }
+
+    bool ok = true;
+
+    for (int i = 1; i < argc; ++i)
+        ok = decodeFile (argv[i]) && ok;
+
+    return ok ? 0 : 1;
+}
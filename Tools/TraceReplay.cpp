@@ -0,0 +1,67 @@
+// Replays captured playhead traces (.bptrace) through the plugin's processor and prints
+// what it reported after every block as tab-separated text.
+//
+// Built by CMake along with the tests, when JUCE is available.
+// Usage:  bptrace-replay playhead.bptrace [more files...]
+
+#include <JuceHeader.h>
+#include "PlayheadTrace.h"
+#include "PluginProcessor.h"
+
+namespace
+{
+    bool replayFile (const juce::File& file)
+    {
+        PlayheadTrace::Replayer replayer;
+
+        if (! replayer.load (file))
+        {
+            std::fprintf (stderr, "%s: not a BPM2Time playhead trace, or from a different version\n",
+                          file.getFullPathName().toRawUTF8());
+            return false;
+        }
+
+        PassthroughTempoProcessor processor;
+        const auto results = replayer.replay (processor);
+        const auto& records = replayer.getRecords();
+
+        std::printf ("# %s: %.0f Hz, %d blocks\n", file.getFileName().toRawUTF8(),
+                     replayer.getHeader().sampleRate, (int) results.size());
+        std::printf ("block\tsamples\thostBpm\tppq\tplaying\teffectiveBpm\tcachedBpm\thostProvided\tmicroseconds\n");
+
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            const auto& r = results[i];
+            const auto pos = PlayheadTrace::decode (records[i]);
+            const auto hostBpm = pos.hasValue() ? pos->getBpm() : juce::Optional<double>();
+            const auto ppq = pos.hasValue() ? pos->getPpqPosition() : juce::Optional<double>();
+
+            std::printf ("%d\t%d\t%s\t%s\t%d\t%.6f\t%.6f\t%d\t%.2f\n",
+                         (int) i, r.numSamples,
+                         hostBpm.hasValue() ? juce::String (*hostBpm, 6).toRawUTF8() : "-",
+                         ppq.hasValue() ? juce::String (*ppq, 6).toRawUTF8() : "-",
+                         pos.hasValue() && pos->getIsPlaying() ? 1 : 0,
+                         r.effectiveBpm, r.cachedBpm, r.hostProvidedBpm ? 1 : 0, r.processMicroseconds);
+        }
+
+        return true;
+    }
+}
+
+int main (int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        std::fprintf (stderr, "usage: %s file.bptrace [...]\n", argv[0]);
+        return 1;
+    }
+
+    // The processor's SharedResourcePointers and parameters expect a message manager
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    bool ok = true;
+
+    for (int i = 1; i < argc; ++i)
+        ok = replayFile (juce::File::getCurrentWorkingDirectory().getChildFile (argv[i])) && ok;
+
+    return ok ? 0 : 1;
+}